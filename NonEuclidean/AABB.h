@@ -0,0 +1,80 @@
+#pragma once
+#include "GameHeader.h"
+#include "Vector.h"
+
+#include <cfloat>
+#include <cmath>
+
+// Axis aligned bounding box
+class AABB
+{
+public:
+    AABB()
+        : min(FLT_MAX)
+        , max(-FLT_MAX)
+    {
+    }
+    AABB(const Vector3& min, const Vector3& max)
+        : min(min)
+        , max(max)
+    {
+    }
+
+    inline bool IsEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    inline Vector3 Center() const { return (min + max) * 0.5f; }
+    inline Vector3 HalfSize() const { return (max - min) * 0.5f; }
+
+    inline void Extend(const Vector3& p)
+    {
+        min.Set(GH_MIN(min.x, p.x), GH_MIN(min.y, p.y), GH_MIN(min.z, p.z));
+        max.Set(GH_MAX(max.x, p.x), GH_MAX(max.y, p.y), GH_MAX(max.z, p.z));
+    }
+    inline void Extend(const AABB& b)
+    {
+        if (!b.IsEmpty())
+        {
+            Extend(b.min);
+            Extend(b.max);
+        }
+    }
+
+    inline AABB Expanded(float r) const { return AABB(min - r, max + r); }
+
+    inline bool Overlaps(const AABB& b) const
+    {
+        return min.x <= b.max.x && max.x >= b.min.x && min.y <= b.max.y && max.y >= b.min.y && min.z <= b.max.z
+               && max.z >= b.min.z;
+    }
+
+    // Bounds of this box after an affine transformation
+    AABB Transformed(const Matrix4& mat) const
+    {
+        if (IsEmpty())
+        {
+            return *this;
+        }
+        const Vector3 c = mat.MulPoint(Center());
+        const Vector3 h = HalfSize();
+        const float* m = mat.m;
+        const Vector3 e(
+            std::abs(m[0]) * h.x + std::abs(m[1]) * h.y + std::abs(m[2]) * h.z,
+            std::abs(m[4]) * h.x + std::abs(m[5]) * h.y + std::abs(m[6]) * h.z,
+            std::abs(m[8]) * h.x + std::abs(m[9]) * h.y + std::abs(m[10]) * h.z);
+        return AABB(c - e, c + e);
+    }
+
+    // Tight bounds of the ellipsoid a unit sphere becomes under an affine transformation
+    static AABB OfUnitSphere(const Matrix4& unitToOut)
+    {
+        const Vector3 c = unitToOut.Translation();
+        const float* m = unitToOut.m;
+        const Vector3 e(
+            std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]),
+            std::sqrt(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]),
+            std::sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10]));
+        return AABB(c - e, c + e);
+    }
+
+    Vector3 min;
+    Vector3 max;
+};
@@ -0,0 +1,108 @@
+#include "AssetLoader.h"
+#include "Timer.h"
+
+#include <algorithm>
+
+AssetLoader::AssetLoader(int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = (int) std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (int i = 0; i < numThreads; ++i) { workers.emplace_back(&AssetLoader::WorkerMain, this); }
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Loads still queued are dropped, the ones running are waited for
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) { worker.join(); }
+}
+
+void AssetLoader::Load(std::function<void()> load, std::function<void()> upload)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back({std::move(load), std::move(upload)});
+        pending += 1;
+    }
+    wake.notify_one();
+}
+
+void AssetLoader::Poll()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploading.swap(finished);
+    }
+    Upload(uploading);
+}
+
+void AssetLoader::Finish()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            loaded.wait(lock, [&] { return pending == 0 || !finished.empty(); });
+            if (pending == 0)
+            {
+                return;
+            }
+            uploading.swap(finished);
+        }
+        Upload(uploading);
+    }
+}
+
+void AssetLoader::Upload(std::vector<Job>& jobs)
+{
+    if (jobs.empty())
+    {
+        return;
+    }
+    Timer timer;
+    for (Job& job : jobs)
+    {
+        job.upload();
+        stats.loads += 1;
+        stats.loadSeconds += job.seconds;
+        stats.slowestSeconds = std::max(stats.slowestSeconds, job.seconds);
+    }
+    stats.uploadSeconds += timer.GetSeconds();
+
+    // Only counted down after the upload, so Finish waits for it too
+    std::lock_guard<std::mutex> lock(mutex);
+    pending -= (int) jobs.size();
+    jobs.clear();
+}
+
+void AssetLoader::WorkerMain()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || !queued.empty(); });
+            if (quit)
+            {
+                return;
+            }
+            job = std::move(queued.front());
+            queued.pop_front();
+        }
+        Timer timer;
+        job.load();
+        job.seconds = timer.GetSeconds();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(std::move(job));
+        }
+        loaded.notify_all();
+    }
+}
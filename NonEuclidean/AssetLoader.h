@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Loads assets in two halves: reading and decoding them on worker threads,
+ * then uploading them on the GL thread, which is the only one allowed to
+ * make GL calls. Uploads run in Poll or Finish, in the order loads finish.
+ */
+class AssetLoader
+{
+public:
+    struct Stats
+    {
+        int64_t loads = 0;
+        double loadSeconds = 0.0;    // Summed over every load, as if they ran one after another
+        double slowestSeconds = 0.0; // Longest single load
+        double uploadSeconds = 0.0;
+    };
+
+    // Zero picks one thread per hardware thread
+    explicit AssetLoader(int numThreads = 0);
+    ~AssetLoader();
+
+    /**
+     * Runs load on a worker thread, then upload on the GL thread. Neither may
+     * touch the asset from anywhere else until upload has run.
+     */
+    void Load(std::function<void()> load, std::function<void()> upload);
+
+    // Uploads the loads that are done, without waiting for the others
+    void Poll();
+
+    // Waits for every load that was started, uploading them as they finish
+    void Finish();
+
+    int NumThreads() const { return (int) workers.size(); }
+
+    Stats stats;
+
+private:
+    struct Job
+    {
+        std::function<void()> load;
+        std::function<void()> upload;
+        double seconds = 0.0;
+    };
+
+    void WorkerMain();
+    void Upload(std::vector<Job>& jobs);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable loaded;
+
+    std::deque<Job> queued;    // Waiting for a worker
+    std::vector<Job> finished; // Waiting for their upload
+    std::vector<Job> uploading;
+    int pending = 0;           // Loads that were started and not uploaded yet
+    bool quit = false;
+};
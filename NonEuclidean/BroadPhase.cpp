@@ -0,0 +1,122 @@
+#include "BroadPhase.h"
+
+#include <algorithm>
+#include <cmath>
+
+BroadPhase::BroadPhase(float cellSize)
+    : invCellSize(1.0f / cellSize)
+{
+}
+
+void BroadPhase::Clear()
+{
+    // Keep the cell vectors around so rebuilding every step does not allocate
+    for (auto& cell : cells) { cell.second.clear(); }
+    oversized.clear();
+    entryBounds.clear();
+}
+
+void BroadPhase::Insert(int id, const AABB& bounds)
+{
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+    if (id >= (int) entryBounds.size())
+    {
+        entryBounds.resize(id + 1);
+    }
+    entryBounds[id] = bounds;
+
+    int lo[3], hi[3];
+    if (!CellRange(bounds, lo, hi))
+    {
+        oversized.push_back(id);
+        return;
+    }
+    for (int x = lo[0]; x <= hi[0]; ++x)
+    {
+        for (int y = lo[1]; y <= hi[1]; ++y)
+        {
+            for (int z = lo[2]; z <= hi[2]; ++z) { cells[CellKey(x, y, z)].push_back(id); }
+        }
+    }
+}
+
+void BroadPhase::Query(const AABB& bounds, std::vector<int>& result) const
+{
+    result.clear();
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    auto visit = [&](int id) {
+        if (entryBounds[id].Overlaps(bounds))
+        {
+            result.push_back(id);
+        }
+    };
+
+    int lo[3], hi[3];
+    if (CellRange(bounds, lo, hi))
+    {
+        for (int x = lo[0]; x <= hi[0]; ++x)
+        {
+            for (int y = lo[1]; y <= hi[1]; ++y)
+            {
+                for (int z = lo[2]; z <= hi[2]; ++z)
+                {
+                    auto cell = cells.find(CellKey(x, y, z));
+                    if (cell != cells.end())
+                    {
+                        for (int id : cell->second) { visit(id); }
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        // Huge query, just test everything
+        for (int id = 0; id < (int) entryBounds.size(); ++id)
+        {
+            if (!entryBounds[id].IsEmpty())
+            {
+                visit(id);
+            }
+        }
+    }
+    for (int id : oversized) { visit(id); }
+
+    // An entry spanning several cells is seen once per cell
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+bool BroadPhase::CellRange(const AABB& bounds, int lo[3], int hi[3]) const
+{
+    const float bmin[3] = {bounds.min.x, bounds.min.y, bounds.min.z};
+    const float bmax[3] = {bounds.max.x, bounds.max.y, bounds.max.z};
+    double numCells = 1.0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const float cellLo = std::floor(bmin[i] * invCellSize);
+        const float cellHi = std::floor(bmax[i] * invCellSize);
+        numCells *= (double) cellHi - (double) cellLo + 1.0;
+        if (numCells > MAX_CELLS_PER_ENTRY)
+        {
+            return false;
+        }
+        lo[i] = (int) cellLo;
+        hi[i] = (int) cellHi;
+    }
+    return true;
+}
+
+uint64_t BroadPhase::CellKey(int x, int y, int z)
+{
+    // 21 bits per axis is plenty for the cell counts of a generated world
+    const uint64_t mask = (1 << 21) - 1;
+    return ((uint64_t) x & mask) | (((uint64_t) y & mask) << 21) | (((uint64_t) z & mask) << 42);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AABB.h"
+#include "GameHeader.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over world space bounds, used to find the objects a physical
+// could be touching without testing it against every object in the scene.
+class BroadPhase
+{
+public:
+    BroadPhase(float cellSize = GH_BROADPHASE_CELL);
+
+    void Clear();
+    void Insert(int id, const AABB& bounds);
+
+    /**
+     * Collects the ids of all inserted bounds that overlap the given bounds.
+     * The result is sorted, so callers see candidates in insertion order.
+     * Queries do not modify the grid and may run concurrently.
+     */
+    void Query(const AABB& bounds, std::vector<int>& result) const;
+
+private:
+    // Objects spanning more cells than this skip the grid and are always tested
+    static const int MAX_CELLS_PER_ENTRY = 512;
+
+    bool CellRange(const AABB& bounds, int lo[3], int hi[3]) const;
+    static uint64_t CellKey(int x, int y, int z);
+
+    float invCellSize;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    std::vector<int> oversized;
+    std::vector<AABB> entryBounds;
+};
@@ -1,5 +1,6 @@
 #include "Camera.h"
 #include "GameHeader.h"
+#include <cfloat>
 #include <cmath>
 #include <glad/glad.h>
 
@@ -69,6 +70,53 @@ Matrix4 Camera::Matrix() const
 void Camera::UseViewport() const
 {
     glViewport(0, 0, width, height);
+    if (visible.IsFull())
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        int x, y, w, h;
+        ScissorRect(x, y, w, h);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, w, h);
+    }
+}
+
+void Camera::ScissorRect(int& x, int& y, int& w, int& h) const
+{
+    // Round outwards, so partially covered pixels are kept
+    x = GH_CLAMP((int) std::floor((visible.x0 * 0.5f + 0.5f) * width), 0, width);
+    y = GH_CLAMP((int) std::floor((visible.y0 * 0.5f + 0.5f) * height), 0, height);
+    w = GH_CLAMP((int) std::ceil((visible.x1 * 0.5f + 0.5f) * width), 0, width) - x;
+    h = GH_CLAMP((int) std::ceil((visible.y1 * 0.5f + 0.5f) * height), 0, height) - y;
+    w = GH_MAX(w, 0);
+    h = GH_MAX(h, 0);
+}
+
+Camera::Rect Camera::Project(const Vector3* points, int count) const
+{
+    const Matrix4 m = Matrix();
+    Rect rect;
+    rect.x0 = rect.y0 = FLT_MAX;
+    rect.x1 = rect.y1 = -FLT_MAX;
+    for (int i = 0; i < count; ++i)
+    {
+        const Vector4 p = m * Vector4(points[i], 1.0f);
+        if (p.w <= 1e-5f)
+        {
+            return visible;
+        }
+        rect.x0 = GH_MIN(rect.x0, p.x / p.w);
+        rect.y0 = GH_MIN(rect.y0, p.y / p.w);
+        rect.x1 = GH_MAX(rect.x1, p.x / p.w);
+        rect.y1 = GH_MAX(rect.y1, p.y / p.w);
+    }
+    rect.x0 = GH_MAX(rect.x0, visible.x0);
+    rect.y0 = GH_MAX(rect.y0, visible.y0);
+    rect.x1 = GH_MIN(rect.x1, visible.x1);
+    rect.y1 = GH_MIN(rect.y1, visible.y1);
+    return rect;
 }
 
 void Camera::ClipOblique(const Vector3& pos, const Vector3& normal)
@@ -86,3 +134,17 @@ void Camera::ClipOblique(const Vector3& pos, const Vector3& normal)
     projection.m[10] = c.z - projection.m[14];
     projection.m[11] = c.w - projection.m[15];
 }
+
+void Camera::Crop(const Rect& rect)
+{
+    const float sx = 2.0f / (rect.x1 - rect.x0);
+    const float sy = 2.0f / (rect.y1 - rect.y0);
+    const float cx = (rect.x0 + rect.x1) * 0.5f;
+    const float cy = (rect.y0 + rect.y1) * 0.5f;
+    for (int i = 0; i < 4; ++i)
+    {
+        projection.m[i] = sx * (projection.m[i] - cx * projection.m[12 + i]);
+        projection.m[4 + i] = sy * (projection.m[4 + i] - cy * projection.m[12 + i]);
+    }
+    visible = Rect();
+}
@@ -4,6 +4,18 @@
 class Camera
 {
 public:
+    // Rectangle in normalized device coordinates
+    struct Rect
+    {
+        float x0 = -1.0f;
+        float y0 = -1.0f;
+        float x1 = 1.0f;
+        float y1 = 1.0f;
+
+        bool IsEmpty() const { return x0 >= x1 || y0 >= y1; }
+        bool IsFull() const { return x0 <= -1.0f && y0 <= -1.0f && x1 >= 1.0f && y1 >= 1.0f; }
+    };
+
     Camera();
 
     Matrix4 InverseProjection() const;
@@ -13,13 +25,29 @@ public:
     void SetSize(int w, int h, float n, float f);
     void SetPositionOrientation(const Vector3& pos, float rotX, float rotY);
 
+    // Sets the viewport, and the scissor test to the visible rectangle
     void UseViewport() const;
 
+    // Visible rectangle in pixels
+    void ScissorRect(int& x, int& y, int& w, int& h) const;
+
+    /**
+     * Part of the visible rectangle covered by the given world space points.
+     * Points behind the camera make it the whole visible rectangle.
+     */
+    Rect Project(const Vector3* points, int count) const;
+
     void ClipOblique(const Vector3& pos, const Vector3& normal);
 
+    // Narrows the projection to the given rectangle, which then fills the whole view
+    void Crop(const Rect& rect);
+
     Matrix4 projection;
     Matrix4 worldView;
 
+    // Only this part of the view can be seen, views through portals shrink it
+    Rect visible;
+
     int width;
     int height;
     float fNear;
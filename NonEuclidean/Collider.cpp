@@ -26,15 +26,21 @@ Collider::Collider(const Vector3& a, const Vector3& b, const Vector3& c)
     }
 }
 
+Collider Collider::FromAxes(const Vector3& center, const Vector3& axisX, const Vector3& axisY)
+{
+    Collider collider;
+    collider.CreateSorted(axisX, center, axisY);
+    return collider;
+}
+
 bool Collider::Collide(const Matrix4& localToUnit, Vector3& delta) const
 {
     // Get world delta
-    const Matrix4 local = localToUnit * mat;
-    const Vector3 v = -local.Translation();
+    const Vector3 v = -localToUnit.MulPoint(center);
 
     // Get axes
-    const Vector3 x = local.XAxis();
-    const Vector3 y = local.YAxis();
+    const Vector3 x = localToUnit.MulDirection(axisX);
+    const Vector3 y = localToUnit.MulDirection(axisY);
 
     // Find closest point
     const float px = GH_CLAMP(v.Dot(x) / x.MagSq(), -1.0f, 1.0f);
@@ -54,6 +60,72 @@ bool Collider::Collide(const Matrix4& localToUnit, Vector3& delta) const
     }
 }
 
+bool Collider::Sweep(const Matrix4& localToUnit, const Vector3& from, float& toi) const
+{
+    // Rectangle relative to the end of the sweep
+    const Vector3 v = -localToUnit.MulPoint(center);
+    const Vector3 x = localToUnit.MulDirection(axisX);
+    const Vector3 y = localToUnit.MulDirection(axisY);
+    const Vector3 n = x.Cross(y);
+
+    // Only a sphere that crosses the plane can tunnel, anything else is
+    // resolved by Collide at the end of the step
+    const float s0 = (from + v).Dot(n);
+    const float s1 = v.Dot(n);
+    if ((s0 > 0.0f) == (s1 > 0.0f))
+    {
+        return false;
+    }
+
+    // Where the center crosses the plane, if that is inside the rectangle
+    // the sphere hits it no later than there
+    const float tc = s0 / (s0 - s1);
+    const Vector3 pc = from * (1.0f - tc) + v;
+    const bool crossesInside = std::abs(pc.Dot(x)) <= x.MagSq() && std::abs(pc.Dot(y)) <= y.MagSq();
+    const float limit = GH_MIN(toi, crossesInside ? tc : 1.0f);
+
+    // Conservative advancement: the sphere cannot get closer faster than it moves
+    const float len = from.Mag();
+    const float target = 1.0f - GH_SWEEP_SKIN;
+    float t = 0.0f;
+    bool touched = false;
+    for (int i = 0; i < GH_SWEEP_ITERATIONS && t < limit; ++i)
+    {
+        const Vector3 p = from * (1.0f - t) + v;
+        const float px = GH_CLAMP(p.Dot(x) / x.MagSq(), -1.0f, 1.0f);
+        const float py = GH_CLAMP(p.Dot(y) / y.MagSq(), -1.0f, 1.0f);
+        const float dist = (p - x * px - y * py).Mag();
+        if (dist <= target)
+        {
+            touched = true;
+            break;
+        }
+        t += (dist - target) / len;
+    }
+
+    // Crossing inside the rectangle is a hit even when advancing did not get
+    // there, it only moves in steps that stay short of the surface
+    if (!touched && !crossesInside)
+    {
+        return false;
+    }
+    t = GH_MIN(t, limit);
+    if (t >= toi)
+    {
+        return false;
+    }
+    toi = t;
+    return true;
+}
+
+AABB Collider::Bounds() const
+{
+    const Vector3 e(
+        std::abs(axisX.x) + std::abs(axisY.x), std::abs(axisX.y) + std::abs(axisY.y),
+        std::abs(axisX.z) + std::abs(axisY.z));
+    return AABB(center - e, center + e);
+}
+
 void Collider::DebugDraw(const Camera& cam, const Matrix4& objMat)
 {
     glDepthFunc(GL_ALWAYS);
@@ -61,6 +133,10 @@ void Collider::DebugDraw(const Camera& cam, const Matrix4& objMat)
     glBegin(GL_LINE_LOOP);
     glColor3f(0.0f, 1.0f, 0.0f);
 
+    Matrix4 mat = Matrix4::Identity();
+    mat.SetTranslation(center);
+    mat.SetXAxis(axisX);
+    mat.SetYAxis(axisY);
     const Matrix4 m = cam.Matrix() * objMat * mat;
     Vector4 v;
 
@@ -88,8 +164,7 @@ void Collider::CreateSorted(const Vector3& da, const Vector3& c, const Vector3&
     //     std::cout << "db = " << db << std::endl;
     // }
     // assert(std::abs(da.Dot(db)) / (da.Mag() * db.Mag()) < 0.001f);
-    mat.MakeIdentity();
-    mat.SetTranslation(c);
-    mat.SetXAxis(da);
-    mat.SetYAxis(db);
+    center = c;
+    axisX = da;
+    axisY = db;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include "AABB.h"
 #include "Vector.h"
 #include "Camera.h"
 
@@ -6,12 +7,30 @@ class Collider {
 public:
   Collider(const Vector3& a, const Vector3& b, const Vector3& c);
 
+  //Create from a center and two half axes
+  static Collider FromAxes(const Vector3& center, const Vector3& axisX, const Vector3& axisY);
+
   bool Collide(const Matrix4& localToWorld, Vector3& delta) const;
 
+  //Sweep the unit sphere from 'from' to the origin. If it passes through the
+  //rectangle, lower toi to the fraction of the sweep where it gets within
+  //GH_SWEEP_SKIN of touching it, if that is earlier.
+  bool Sweep(const Matrix4& localToUnit, const Vector3& from, float& toi) const;
+
+  AABB Bounds() const;
+
   void DebugDraw(const Camera& cam, const Matrix4& objMat);
 
+  //Rectangle center and half axes
+  const Vector3& Center() const { return center; }
+  const Vector3& AxisX() const { return axisX; }
+  const Vector3& AxisY() const { return axisY; }
+
 private:
+  Collider() {}
   void CreateSorted(const Vector3& da, const Vector3& c, const Vector3& db);
 
-  Matrix4 mat;
-};
\ No newline at end of file
+  Vector3 center;
+  Vector3 axisX;
+  Vector3 axisY;
+};
@@ -0,0 +1,123 @@
+#include "ColliderBVH.h"
+
+#include <algorithm>
+
+void ColliderBVH::Build(std::vector<Collider>& colliders)
+{
+    nodes.clear();
+    if (colliders.empty())
+    {
+        return;
+    }
+
+    // Temporaries
+    std::vector<uint32_t> order(colliders.size());
+    std::vector<AABB> bounds(colliders.size());
+    std::vector<Vector3> centers(colliders.size());
+    for (size_t i = 0; i < colliders.size(); ++i)
+    {
+        order[i] = (uint32_t) i;
+        bounds[i] = colliders[i].Bounds();
+        centers[i] = bounds[i].Center();
+    }
+
+    // Root covers everything, split it recursively
+    Node root;
+    root.first = 0;
+    root.count = (uint32_t) colliders.size();
+    for (size_t i = 0; i < bounds.size(); ++i) { root.bounds.Extend(bounds[i]); }
+    nodes.reserve(2 * colliders.size() / MAX_LEAF_SIZE + 1);
+    nodes.push_back(root);
+    Split(0, order, bounds, centers, 0);
+
+    // Reorder the colliders to match the leaves
+    std::vector<Collider> sorted;
+    sorted.reserve(colliders.size());
+    for (size_t i = 0; i < order.size(); ++i) { sorted.push_back(colliders[order[i]]); }
+    colliders.swap(sorted);
+}
+
+void ColliderBVH::Split(
+    uint32_t nodeIx,
+    std::vector<uint32_t>& order,
+    const std::vector<AABB>& bounds,
+    const std::vector<Vector3>& centers,
+    int depth)
+{
+    const uint32_t first = nodes[nodeIx].first;
+    const uint32_t count = nodes[nodeIx].count;
+    if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH - 1)
+    {
+        return;
+    }
+
+    // Split at the median along the longest axis of the centers
+    AABB centerBounds;
+    for (uint32_t i = first; i < first + count; ++i) { centerBounds.Extend(centers[order[i]]); }
+    const Vector3 extent = centerBounds.max - centerBounds.min;
+    int axis = 0;
+    if (extent.y > extent.x && extent.y >= extent.z)
+    {
+        axis = 1;
+    }
+    else if (extent.z > extent.x && extent.z > extent.y)
+    {
+        axis = 2;
+    }
+    auto key = [&](uint32_t ix) {
+        const Vector3& c = centers[ix];
+        return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+    };
+    const uint32_t half = count / 2;
+    std::nth_element(
+        order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+        [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+
+    // Children are stored next to each other
+    const uint32_t childIx = (uint32_t) nodes.size();
+    Node left, right;
+    left.first = first;
+    left.count = half;
+    right.first = first + half;
+    right.count = count - half;
+    for (uint32_t i = left.first; i < left.first + left.count; ++i) { left.bounds.Extend(bounds[order[i]]); }
+    for (uint32_t i = right.first; i < right.first + right.count; ++i) { right.bounds.Extend(bounds[order[i]]); }
+    nodes.push_back(left);
+    nodes.push_back(right);
+    nodes[nodeIx].first = childIx;
+    nodes[nodeIx].count = 0;
+
+    Split(childIx, order, bounds, centers, depth + 1);
+    Split(childIx + 1, order, bounds, centers, depth + 1);
+}
+
+void ColliderBVH::Query(const AABB& bounds, std::vector<Range>& ranges) const
+{
+    ranges.clear();
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    uint32_t stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = nodes[stack[--top]];
+        if (!node.bounds.Overlaps(bounds))
+        {
+            continue;
+        }
+        if (node.count > 0)
+        {
+            ranges.push_back({node.first, node.count});
+        }
+        else
+        {
+            // Left child holds the lower colliders, visiting it first keeps the ranges sorted
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+        }
+    }
+}
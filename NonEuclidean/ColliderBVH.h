@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AABB.h"
+#include "Collider.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Bounding volume hierarchy over the colliders of a mesh
+class ColliderBVH
+{
+public:
+    // A run of colliders [first, first + count)
+    struct Range
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct Node
+    {
+        AABB bounds;
+        uint32_t first; // Index of the first child for inner nodes, of the first collider for leaves
+        uint32_t count; // Number of colliders, 0 for inner nodes
+    };
+
+    /**
+     * Builds the hierarchy. The colliders are reordered so that every leaf
+     * refers to a contiguous range of them.
+     */
+    void Build(std::vector<Collider>& colliders);
+
+    /**
+     * Collects the leaves whose bounds overlap the given bounds. Ranges are
+     * returned in ascending order, so colliders are visited in array order.
+     */
+    void Query(const AABB& bounds, std::vector<Range>& ranges) const;
+
+    bool Empty() const { return nodes.empty(); }
+    size_t NumNodes() const { return nodes.size(); }
+
+    // Nodes of a hierarchy built before, for colliders already in its order, see Mesh::Bake
+    const std::vector<Node>& Nodes() const { return nodes; }
+    void Assign(std::vector<Node> built) { nodes = std::move(built); }
+
+private:
+    static const uint32_t MAX_LEAF_SIZE = 4;
+    static const int MAX_DEPTH = 64;
+
+    void Split(
+        uint32_t nodeIx,
+        std::vector<uint32_t>& order,
+        const std::vector<AABB>& bounds,
+        const std::vector<Vector3>& centers,
+        int depth);
+
+    std::vector<Node> nodes;
+};
@@ -0,0 +1,226 @@
+#include "ColliderSoA.h"
+#include "GameHeader.h"
+
+#if defined(__AVX2__)
+#    define GH_COLLIDER_AVX2
+#    include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define GH_COLLIDER_SSE
+#    include <emmintrin.h>
+#endif
+
+void ColliderSoA::Assign(const std::vector<Collider>& colliders)
+{
+    Clear();
+    for (size_t i = 0; i < colliders.size(); ++i) { Append(colliders[i]); }
+}
+
+void ColliderSoA::Append(const Collider& collider)
+{
+    const Vector3& c = collider.Center();
+    const Vector3& x = collider.AxisX();
+    const Vector3& y = collider.AxisY();
+    cx.push_back(c.x);
+    cy.push_back(c.y);
+    cz.push_back(c.z);
+    xx.push_back(x.x);
+    xy.push_back(x.y);
+    xz.push_back(x.z);
+    yx.push_back(y.x);
+    yy.push_back(y.y);
+    yz.push_back(y.z);
+}
+
+void ColliderSoA::Erase(size_t first, size_t count)
+{
+    for (std::vector<float>* v : {&cx, &cy, &cz, &xx, &xy, &xz, &yx, &yy, &yz})
+    {
+        v->erase(v->begin() + first, v->begin() + first + count);
+    }
+}
+
+void ColliderSoA::Clear()
+{
+    for (std::vector<float>* v : {&cx, &cy, &cz, &xx, &xy, &xz, &yx, &yy, &yz}) { v->clear(); }
+}
+
+Collider ColliderSoA::Get(size_t i) const
+{
+    return Collider::FromAxes(Vector3(cx[i], cy[i], cz[i]), Vector3(xx[i], xy[i], xz[i]), Vector3(yx[i], yy[i], yz[i]));
+}
+
+bool ColliderSoA::CollideOne(const Matrix4& localToUnit, size_t i, Vector3& push) const
+{
+    // Same math as Collider::Collide, reading straight from the arrays
+    const float* m = localToUnit.m;
+    const Vector3 v(
+        -(m[0] * cx[i] + m[1] * cy[i] + m[2] * cz[i] + m[3]), -(m[4] * cx[i] + m[5] * cy[i] + m[6] * cz[i] + m[7]),
+        -(m[8] * cx[i] + m[9] * cy[i] + m[10] * cz[i] + m[11]));
+    const Vector3 x(
+        m[0] * xx[i] + m[1] * xy[i] + m[2] * xz[i], m[4] * xx[i] + m[5] * xy[i] + m[6] * xz[i],
+        m[8] * xx[i] + m[9] * xy[i] + m[10] * xz[i]);
+    const Vector3 y(
+        m[0] * yx[i] + m[1] * yy[i] + m[2] * yz[i], m[4] * yx[i] + m[5] * yy[i] + m[6] * yz[i],
+        m[8] * yx[i] + m[9] * yy[i] + m[10] * yz[i]);
+
+    const float px = GH_CLAMP(v.Dot(x) / x.MagSq(), -1.0f, 1.0f);
+    const float py = GH_CLAMP(v.Dot(y) / y.MagSq(), -1.0f, 1.0f);
+    const Vector3 delta = v - (x * px + y * py);
+    if (!(delta.MagSq() < 1.0f))
+    {
+        return false;
+    }
+    push = delta.Normalized() - delta;
+    return true;
+}
+
+int64_t ColliderSoA::CollideFirstScalar(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const
+{
+    for (size_t i = first; i < first + count; ++i)
+    {
+        if (CollideOne(localToUnit, i, push))
+        {
+            return (int64_t) i;
+        }
+    }
+    return -1;
+}
+
+#if defined(GH_COLLIDER_AVX2)
+
+int64_t ColliderSoA::CollideFirst(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const
+{
+    __m256 m[12];
+    for (int i = 0; i < 12; ++i) { m[i] = _mm256_set1_ps(localToUnit.m[i]); }
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minusOne = _mm256_set1_ps(-1.0f);
+
+    size_t i = first;
+    const size_t end = first + count;
+    for (; i + 8 <= end; i += 8)
+    {
+        // Transform the centers and axes of 8 colliders into unit space
+        const __m256 ccx = _mm256_loadu_ps(&cx[i]), ccy = _mm256_loadu_ps(&cy[i]), ccz = _mm256_loadu_ps(&cz[i]);
+        const __m256 cxx = _mm256_loadu_ps(&xx[i]), cxy = _mm256_loadu_ps(&xy[i]), cxz = _mm256_loadu_ps(&xz[i]);
+        const __m256 cyx = _mm256_loadu_ps(&yx[i]), cyy = _mm256_loadu_ps(&yy[i]), cyz = _mm256_loadu_ps(&yz[i]);
+        auto dir = [&](int row, __m256 a, __m256 b, __m256 c) {
+            return _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(m[row * 4], a), _mm256_mul_ps(m[row * 4 + 1], b)),
+                _mm256_mul_ps(m[row * 4 + 2], c));
+        };
+        const __m256 vx = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_add_ps(dir(0, ccx, ccy, ccz), m[3]));
+        const __m256 vy = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_add_ps(dir(1, ccx, ccy, ccz), m[7]));
+        const __m256 vz = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_add_ps(dir(2, ccx, ccy, ccz), m[11]));
+        const __m256 ax = dir(0, cxx, cxy, cxz), ay = dir(1, cxx, cxy, cxz), az = dir(2, cxx, cxy, cxz);
+        const __m256 bx = dir(0, cyx, cyy, cyz), by = dir(1, cyx, cyy, cyz), bz = dir(2, cyx, cyy, cyz);
+
+        // Closest point on the rectangle
+        auto dot = [](__m256 a0, __m256 a1, __m256 a2, __m256 b0, __m256 b1, __m256 b2) {
+            return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1)), _mm256_mul_ps(a2, b2));
+        };
+        const __m256 px = _mm256_min_ps(
+            _mm256_max_ps(_mm256_div_ps(dot(vx, vy, vz, ax, ay, az), dot(ax, ay, az, ax, ay, az)), minusOne), one);
+        const __m256 py = _mm256_min_ps(
+            _mm256_max_ps(_mm256_div_ps(dot(vx, vy, vz, bx, by, bz), dot(bx, by, bz, bx, by, bz)), minusOne), one);
+        const __m256 dx = _mm256_sub_ps(vx, _mm256_add_ps(_mm256_mul_ps(ax, px), _mm256_mul_ps(bx, py)));
+        const __m256 dy = _mm256_sub_ps(vy, _mm256_add_ps(_mm256_mul_ps(ay, px), _mm256_mul_ps(by, py)));
+        const __m256 dz = _mm256_sub_ps(vz, _mm256_add_ps(_mm256_mul_ps(az, px), _mm256_mul_ps(bz, py)));
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(dot(dx, dy, dz, dx, dy, dz), one, _CMP_LT_OQ));
+
+        // Hits are rare, resolve them one at a time to get the exact push
+        if (mask != 0)
+        {
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                if ((mask & (1 << lane)) && CollideOne(localToUnit, i + lane, push))
+                {
+                    return (int64_t) (i + lane);
+                }
+            }
+        }
+    }
+    return CollideFirstScalar(localToUnit, i, end - i, push);
+}
+
+#elif defined(GH_COLLIDER_SSE)
+
+int64_t ColliderSoA::CollideFirst(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const
+{
+    __m128 m[12];
+    for (int i = 0; i < 12; ++i) { m[i] = _mm_set1_ps(localToUnit.m[i]); }
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+
+    size_t i = first;
+    const size_t end = first + count;
+    for (; i + 4 <= end; i += 4)
+    {
+        // Transform the centers and axes of 4 colliders into unit space
+        const __m128 ccx = _mm_loadu_ps(&cx[i]), ccy = _mm_loadu_ps(&cy[i]), ccz = _mm_loadu_ps(&cz[i]);
+        const __m128 cxx = _mm_loadu_ps(&xx[i]), cxy = _mm_loadu_ps(&xy[i]), cxz = _mm_loadu_ps(&xz[i]);
+        const __m128 cyx = _mm_loadu_ps(&yx[i]), cyy = _mm_loadu_ps(&yy[i]), cyz = _mm_loadu_ps(&yz[i]);
+        auto dir = [&](int row, __m128 a, __m128 b, __m128 c) {
+            return _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(m[row * 4], a), _mm_mul_ps(m[row * 4 + 1], b)), _mm_mul_ps(m[row * 4 + 2], c));
+        };
+        const __m128 vx = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(dir(0, ccx, ccy, ccz), m[3]));
+        const __m128 vy = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(dir(1, ccx, ccy, ccz), m[7]));
+        const __m128 vz = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(dir(2, ccx, ccy, ccz), m[11]));
+        const __m128 ax = dir(0, cxx, cxy, cxz), ay = dir(1, cxx, cxy, cxz), az = dir(2, cxx, cxy, cxz);
+        const __m128 bx = dir(0, cyx, cyy, cyz), by = dir(1, cyx, cyy, cyz), bz = dir(2, cyx, cyy, cyz);
+
+        // Closest point on the rectangle
+        auto dot = [](__m128 a0, __m128 a1, __m128 a2, __m128 b0, __m128 b1, __m128 b2) {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, b0), _mm_mul_ps(a1, b1)), _mm_mul_ps(a2, b2));
+        };
+        const __m128 px =
+            _mm_min_ps(_mm_max_ps(_mm_div_ps(dot(vx, vy, vz, ax, ay, az), dot(ax, ay, az, ax, ay, az)), minusOne), one);
+        const __m128 py =
+            _mm_min_ps(_mm_max_ps(_mm_div_ps(dot(vx, vy, vz, bx, by, bz), dot(bx, by, bz, bx, by, bz)), minusOne), one);
+        const __m128 dx = _mm_sub_ps(vx, _mm_add_ps(_mm_mul_ps(ax, px), _mm_mul_ps(bx, py)));
+        const __m128 dy = _mm_sub_ps(vy, _mm_add_ps(_mm_mul_ps(ay, px), _mm_mul_ps(by, py)));
+        const __m128 dz = _mm_sub_ps(vz, _mm_add_ps(_mm_mul_ps(az, px), _mm_mul_ps(bz, py)));
+        const int mask = _mm_movemask_ps(_mm_cmplt_ps(dot(dx, dy, dz, dx, dy, dz), one));
+
+        // Hits are rare, resolve them one at a time to get the exact push
+        if (mask != 0)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if ((mask & (1 << lane)) && CollideOne(localToUnit, i + lane, push))
+                {
+                    return (int64_t) (i + lane);
+                }
+            }
+        }
+    }
+    return CollideFirstScalar(localToUnit, i, end - i, push);
+}
+
+#else
+
+int64_t ColliderSoA::CollideFirst(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const
+{
+    return CollideFirstScalar(localToUnit, first, count, push);
+}
+
+#endif
+
+int64_t ColliderSoA::SweepFirst(
+    const Matrix4& localToUnit,
+    const Vector3& from,
+    size_t first,
+    size_t count,
+    float& toi) const
+{
+    // Rare enough that batching does not pay off
+    int64_t hit = -1;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        if (Get(i).Sweep(localToUnit, from, toi))
+        {
+            hit = (int64_t) i;
+        }
+    }
+    return hit;
+}
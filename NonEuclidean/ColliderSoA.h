@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Collider.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Colliders stored as a structure of arrays (center, half axis X, half axis
+ * Y), so a hit sphere can be tested against several of them at once.
+ */
+class ColliderSoA
+{
+public:
+    void Assign(const std::vector<Collider>& colliders);
+    void Append(const Collider& collider);
+    void Erase(size_t first, size_t count);
+    void Clear();
+
+    size_t Size() const { return cx.size(); }
+    bool Empty() const { return cx.empty(); }
+    Collider Get(size_t i) const;
+
+    /**
+     * Tests the unit sphere against colliders [first, first + count), given
+     * the transformation from collider space to the sphere's unit space.
+     * Returns the index of the first collider that is hit and sets the push
+     * that resolves it, or returns -1 if none of them are hit.
+     */
+    int64_t CollideFirst(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const;
+
+    // Same as CollideFirst, testing one collider at a time
+    int64_t CollideFirstScalar(const Matrix4& localToUnit, size_t first, size_t count, Vector3& push) const;
+
+    /**
+     * Sweeps the unit sphere from 'from' to the origin through colliders
+     * [first, first + count), see Collider::Sweep. Returns the index of the
+     * collider it passes through first and lowers toi, or returns -1 if it
+     * does not pass through any of them before toi.
+     */
+    int64_t SweepFirst(const Matrix4& localToUnit, const Vector3& from, size_t first, size_t count, float& toi) const;
+
+private:
+    bool CollideOne(const Matrix4& localToUnit, size_t i, Vector3& push) const;
+
+    std::vector<float> cx, cy, cz; // Centers
+    std::vector<float> xx, xy, xz; // Half axes X
+    std::vector<float> yx, yy, yz; // Half axes Y
+};
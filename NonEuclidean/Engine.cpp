@@ -1,4 +1,5 @@
 #include "Engine.h"
+#include "Frustum.h"
 #include "InfiniteSpace.h"
 #include "Physical.h"
 
@@ -9,16 +10,36 @@
 Engine* GH_ENGINE = nullptr;
 Player* GH_PLAYER = nullptr;
 const Input* GH_INPUT = nullptr;
+AssetLoader* GH_ASSETS = nullptr;
 int GH_REC_LEVEL = 0;
 int64_t GH_FRAME = 0;
+float GH_DT = 1.0f / GH_PHYSICS_RATE;
+float GH_DT_SCALE = GH_DT / GH_DT_TUNED;
+float GH_BOB_RETAIN = 1.0f - GH_BOB_DAMP;
+
+// Bounds to query colliders a sphere may hit with. Rounding in the bounds
+// would otherwise miss the colliders a sphere rests on after a push.
+static AABB SphereQueryBounds(const Matrix4& unitToOut)
+{
+    return AABB::OfUnitSphere(unitToOut * Matrix4::Scale(1.0f + GH_QUERY_SKIN));
+}
 
 Engine::Engine(Args args)
     : args(args)
 {
     GH_ENGINE = this;
     GH_INPUT = &input;
+    GH_DT = 1.0f / GH_MAX(args.physicsRate, 1);
+    GH_DT_SCALE = GH_DT / GH_DT_TUNED;
+    GH_BOB_RETAIN = GH_STEP_RETAIN(GH_BOB_DAMP);
     isFullscreen = true;
 
+    // Assets load in the background while the window and the scene are set up
+    Timer startup;
+    assets.reset(new AssetLoader(args.loaderThreads));
+    GH_ASSETS = assets.get();
+
+#ifndef GH_HEADLESS
     if (args.enableVr)
     {
         InitVR();
@@ -27,6 +48,14 @@ Engine::Engine(Args args)
     CreateGLWindow();
     InitGLObjects();
     input.SetupCallbacks(window);
+#else
+    // Nothing to render to, and no VR runtime to ask for poses
+    this->args.enableVr = false;
+    occlusionCullingSupported = 0;
+#endif
+
+    physicsPool.reset(new ThreadPool(args.physicsThreads));
+    physicsScratch.resize(physicsPool->NumThreads());
 
     player.reset(new Player);
     GH_PLAYER = player.get();
@@ -35,11 +64,25 @@ Engine::Engine(Args args)
 
     LoadScene(0);
 
+#ifndef GH_HEADLESS
     sky.reset(new Sky);
+#endif
+
+    assets->Finish();
+    if (args.showStats)
+    {
+        const AssetLoader::Stats& loaded = assets->stats;
+        printf(
+            "assets: %lld loaded in %.1f ms on %d threads, %.1f ms one by one, slowest %.1f ms, %.1f ms uploading\n",
+            (long long) loaded.loads, startup.GetSeconds() * 1e3, assets->NumThreads(), loaded.loadSeconds * 1e3,
+            loaded.slowestSeconds * 1e3, loaded.uploadSeconds * 1e3);
+    }
 }
 
 Engine::~Engine()
 {
+    GH_ASSETS = nullptr;
+#ifndef GH_HEADLESS
     glfwDestroyWindow(window);
     glfwTerminate();
 
@@ -47,12 +90,16 @@ Engine::~Engine()
     {
         vr::VR_Shutdown();
     }
+#endif
 }
 
+#ifndef GH_HEADLESS
 int Engine::Run()
 {
     // Setup the timer
     double cur_time = timer.GetSeconds();
+    double stats_time = cur_time;
+    int64_t stats_frames = 0;
     GH_FRAME = 0;
 
     // Game loop
@@ -106,16 +153,23 @@ int Engine::Run()
         const double new_time = timer.GetSeconds();
         for (int i = 0; cur_time < new_time && i < GH_MAX_STEPS; ++i)
         {
-            Update();
-            if (!args.enableVr)
-            {
-                TryPortals();
-            }
+            Step();
             cur_time += GH_DT;
-            GH_FRAME += 1;
-            input.EndFrame();
         }
-        cur_time = (cur_time < new_time ? new_time : cur_time);
+        if (cur_time < new_time)
+        {
+            // Too far behind, give up on the rest instead of spiraling
+            physicsStats.droppedSteps += (int64_t) std::ceil((new_time - cur_time) / GH_DT);
+            physicsStats.clampedFrames += 1;
+            cur_time = new_time;
+        }
+
+        // Whatever finished loading since the last frame can be drawn now
+        assets->Poll();
+
+        // The simulation is up to one step ahead of the clock, draw in between
+        // its last two states so motion stays smooth at low physics rates
+        InterpolatePhysicals((float) GH_CLAMP(1.0 - (cur_time - new_time) / GH_DT, 0.0, 1.0));
 
         const float n = GH_CLAMP(NearestPortalDist() * 0.5f, GH_NEAR_MIN, GH_NEAR_MAX);
 
@@ -128,6 +182,7 @@ int Engine::Run()
             main_cam.UseViewport();
 
             GH_REC_LEVEL = GH_MAX_RECURSION;
+            renderView = 0;
             screenBuffer->Bind();
             Render(main_cam, screenBuffer->Fbo(), nullptr);
 
@@ -163,6 +218,7 @@ int Engine::Run()
                 main_cam.SetSize(iWidth, iHeight, n, GH_FAR);
                 main_cam.UseViewport();
                 GH_REC_LEVEL = GH_MAX_RECURSION;
+                renderView = 0;
                 screenBuffer->Bind();
                 Render(main_cam, screenBuffer->Fbo(), nullptr);
 
@@ -186,18 +242,20 @@ int Engine::Run()
             }
 
             auto RenderView = [&](const std::shared_ptr<FrameBuffer>& view, Matrix4 viewMatrix, Matrix4 eyeMatrix,
-                                  Matrix4 projectionMatrix) {
+                                  Matrix4 projectionMatrix, uint64_t eye) {
                 Camera cam;
                 cam.worldView = eyeMatrix * viewMatrix;
                 cam.SetSize(hmdWidth, hmdHeight, n, GH_FAR);
                 cam.projection = projectionMatrix;
 
+                renderView = eye;
                 view->Render(cam, 0, nullptr);
+                renderView = 0;
             };
 
             // render views
-            RenderView(leftView, viewMatrix, eyeMatrixLeft, projectionMatrixLeft);
-            RenderView(rightView, viewMatrix, eyeMatrixRight, projectionMatrixRight);
+            RenderView(leftView, viewMatrix, eyeMatrixLeft, projectionMatrixLeft, 1);
+            RenderView(rightView, viewMatrix, eyeMatrixRight, projectionMatrixRight, 2);
 
             // present to HMD
             vr::Texture_t leftTexture = {(void*) leftView->TexId(), vr::TextureType_OpenGL, vr::ColorSpace_Gamma};
@@ -206,12 +264,34 @@ int Engine::Run()
             vr::VRCompositor()->Submit(vr::Eye_Right, &rightTexture);
         }
 
+        RestorePhysicals();
+        portalQueries.EndFrame();
         glfwSwapBuffers(window);
+
+        stats_frames += 1;
+        if (args.showStats && new_time - stats_time >= 1.0)
+        {
+            ReportStats(new_time - stats_time, stats_frames);
+            stats_time = new_time;
+            stats_frames = 0;
+        }
     }
 
     DestroyGLObjects();
     return 0;
 }
+#endif
+
+void Engine::Step()
+{
+    Update();
+    if (!args.enableVr)
+    {
+        TryPortals();
+    }
+    GH_FRAME += 1;
+    input.EndFrame();
+}
 
 void Engine::LoadScene(int ix)
 {
@@ -263,7 +343,26 @@ void Engine::Update()
     // }
 
     // Collisions
-    // For each physics object
+    // Broad phase: bin every object that can be collided with, static
+    // geometry is already baked into the scene's static world. Meshes that
+    // are still loading are left out until they are ready, so a step never
+    // waits for them
+    const StaticWorld& staticWorld = curScene->staticWorld;
+    broadPhase.Clear();
+    objectTransforms.resize(vObjects.size());
+    for (size_t j = 0; j < vObjects.size(); ++j)
+    {
+        const Mesh* mesh = vObjects[j]->mesh.get();
+        if (mesh && mesh->IsReady() && !staticWorld.Contains(*vObjects[j]))
+        {
+            broadPhase.Insert((int) j, vObjects[j]->WorldBounds());
+            objectTransforms[j] = {vObjects[j]->LocalToWorld(), vObjects[j]->WorldToLocal()};
+        }
+    }
+    physicsStats.steps += 1;
+
+    // Gather the physics objects
+    size_t numJobs = 0;
     for (size_t i = 0; i < vObjects.size(); ++i)
     {
         Physical* physical = vObjects[i]->AsPhysical();
@@ -271,47 +370,125 @@ void Engine::Update()
         {
             continue;
         }
-        Matrix4 worldToLocal = physical->WorldToLocal();
+        if (numJobs == physicsJobs.size())
+        {
+            physicsJobs.emplace_back();
+        }
+        PhysicsJob& job = physicsJobs[numJobs++];
+        job.objectIx = (int) i;
+        job.physical = physical;
+        job.contacts.clear();
+        job.stats = PhysicsStats();
+    }
+
+    // Narrow phase: every physical resolves its own hits against the
+    // transforms from before this phase, independent of the others
+    physicsPool->ParallelFor(numJobs, [&](size_t k, int thread) {
+        // Count this job's transform lookups on their own, the thread may be the main one
+        const Object::TransformCounts counts = Object::transformCounts;
+        Object::transformCounts = Object::TransformCounts();
+        NarrowPhase(physicsJobs[k], physicsScratch[thread]);
+        physicsJobs[k].stats.transforms = Object::transformCounts;
+        Object::transformCounts = counts;
+    });
+
+    // Tell the other objects about the hits, in a fixed order
+    for (size_t k = 0; k < numJobs; ++k)
+    {
+        PhysicsJob& job = physicsJobs[k];
+        for (Contact& contact : job.contacts) { contact.other->OnHit(*job.physical, contact.push); }
+        physicsStats += job.stats;
+    }
+}
 
-        // For each object to collide with
-        for (size_t j = 0; j < vObjects.size(); ++j)
+void Engine::NarrowPhase(PhysicsJob& job, PhysicsScratch& scratch)
+{
+    Physical& physical = *job.physical;
+    const StaticWorld& staticWorld = curScene->staticWorld;
+    if (args.continuousCollision)
+    {
+        Sweep(job, scratch);
+    }
+    broadPhase.Query(physical.HitBounds(), job.candidates);
+
+    // Static geometry, tested without any per object matrix work. Colliders
+    // are tested in array order, and every push moves the sphere, so the
+    // colliders after a hit are queried again around where it moved to
+    for (size_t s = 0; s < physical.hitSpheres.size(); ++s)
+    {
+        const Sphere& sphere = physical.hitSpheres[s];
+        Matrix4 worldToUnit = sphere.LocalToUnit() * physical.WorldToLocal();
+        Matrix4 unitToWorld = worldToUnit.Inverse();
+        size_t next = 0;
+        for (bool pushed = true; pushed;)
         {
-            if (i == j)
+            pushed = false;
+            staticWorld.Query(
+                SphereQueryBounds(unitToWorld), scratch.staticRanges, scratch.staticChunks, scratch.chunkRanges);
+            for (const StaticWorld::Range& range : scratch.staticRanges)
             {
-                continue;
-            }
-            Object& obj = *vObjects[j];
-            if (!obj.mesh)
-            {
-                continue;
+                const size_t first = GH_MAX((size_t) range.first, next);
+                const size_t end = (size_t) range.first + range.count;
+                if (first >= end)
+                {
+                    continue;
+                }
+                const int64_t hit = CollideRange(
+                    job, sphere, *range.owner, Matrix4::Identity(), staticWorld.Colliders(), first, end - first,
+                    worldToUnit, unitToWorld);
+                if (hit >= 0)
+                {
+                    next = (size_t) hit + 1;
+                    pushed = true;
+                    break;
+                }
             }
+        }
+    }
 
-            // For each hit sphere
-            for (size_t s = 0; s < physical->hitSpheres.size(); ++s)
+    // For each nearby object to collide with
+    for (int j : job.candidates)
+    {
+        if (j == job.objectIx)
+        {
+            continue;
+        }
+        job.stats.candidatePairs += 1;
+        Object& obj = *vObjects[j];
+        const ObjectTransform& transform = objectTransforms[j];
+
+        // For each hit sphere
+        for (size_t s = 0; s < physical.hitSpheres.size(); ++s)
+        {
+            // Brings point from hits's local coordinates to world
+            // coordinates and back.
+            const Sphere& sphere = physical.hitSpheres[s];
+            Matrix4 worldToUnit = sphere.LocalToUnit() * physical.WorldToLocal();
+            Matrix4 unitToWorld = worldToUnit.Inverse();
+
+            // Only visit the colliders near the sphere, and near where each push moves it
+            size_t next = 0;
+            for (bool pushed = true; pushed;)
             {
-                // Brings point from collider's local coordinates to hits's
-                // local coordinates.
-                const Sphere& sphere = physical->hitSpheres[s];
-                Matrix4 worldToUnit = sphere.LocalToUnit() * worldToLocal;
-                Matrix4 localToUnit = worldToUnit * obj.LocalToWorld();
-                Matrix4 unitToWorld = worldToUnit.Inverse();
-
-                // For each collider
-                for (size_t c = 0; c < obj.mesh->colliders.size(); ++c)
+                pushed = false;
+                const AABB sphereBounds = SphereQueryBounds(transform.worldToLocal * unitToWorld);
+                obj.mesh->colliderBVH.Query(sphereBounds, scratch.colliderRanges);
+                for (const ColliderBVH::Range& range : scratch.colliderRanges)
                 {
-                    Vector3 push;
-                    const Collider& collider = obj.mesh->colliders[c];
-                    if (collider.Collide(localToUnit, push))
+                    const size_t first = GH_MAX((size_t) range.first, next);
+                    const size_t end = (size_t) range.first + range.count;
+                    if (first >= end)
                     {
-                        // If push is too small, just ignore
-                        push = unitToWorld.MulDirection(push);
-                        vObjects[j]->OnHit(*physical, push);
-                        physical->OnCollide(*vObjects[j], push);
-
-                        worldToLocal = physical->WorldToLocal();
-                        worldToUnit = sphere.LocalToUnit() * worldToLocal;
-                        localToUnit = worldToUnit * obj.LocalToWorld();
-                        unitToWorld = worldToUnit.Inverse();
+                        continue;
+                    }
+                    const int64_t hit = CollideRange(
+                        job, sphere, obj, transform.localToWorld, obj.mesh->colliders, first, end - first,
+                        worldToUnit, unitToWorld);
+                    if (hit >= 0)
+                    {
+                        next = (size_t) hit + 1;
+                        pushed = true;
+                        break;
                     }
                 }
             }
@@ -319,6 +496,106 @@ void Engine::Update()
     }
 }
 
+void Engine::Sweep(PhysicsJob& job, PhysicsScratch& scratch)
+{
+    // Only spheres that moved a good part of their radius can pass through a
+    // collider, slower ones are left to the discrete tests
+    Physical& physical = *job.physical;
+    const Vector3 back = physical.prev_pos - physical.pos;
+    const Matrix4 worldToLocal = physical.WorldToLocal();
+    AABB sweptBounds;
+    for (size_t s = 0; s < physical.hitSpheres.size(); ++s)
+    {
+        const Matrix4 worldToUnit = physical.hitSpheres[s].LocalToUnit() * worldToLocal;
+        if (worldToUnit.MulDirection(back).MagSq() > GH_SWEEP_MIN * GH_SWEEP_MIN)
+        {
+            const AABB bounds = AABB::OfUnitSphere(worldToUnit.Inverse());
+            sweptBounds.Extend(bounds);
+            sweptBounds.Extend(AABB(bounds.min + back, bounds.max + back));
+        }
+    }
+    if (sweptBounds.IsEmpty())
+    {
+        return;
+    }
+
+    // Earliest time of impact over the spheres and everything along their
+    // paths, colliders of other objects are taken where they are now
+    const StaticWorld& staticWorld = curScene->staticWorld;
+    broadPhase.Query(sweptBounds, job.candidates);
+    staticWorld.Query(sweptBounds, scratch.staticRanges, scratch.staticChunks, scratch.chunkRanges);
+    float toi = 1.0f;
+    for (size_t s = 0; s < physical.hitSpheres.size(); ++s)
+    {
+        const Matrix4 worldToUnit = physical.hitSpheres[s].LocalToUnit() * worldToLocal;
+        const Vector3 from = worldToUnit.MulDirection(back);
+        if (from.MagSq() <= GH_SWEEP_MIN * GH_SWEEP_MIN)
+        {
+            continue;
+        }
+        job.stats.sweeps += 1;
+        for (const StaticWorld::Range& range : scratch.staticRanges)
+        {
+            staticWorld.Colliders().SweepFirst(worldToUnit, from, range.first, range.count, toi);
+        }
+        for (int j : job.candidates)
+        {
+            if (j == job.objectIx)
+            {
+                continue;
+            }
+            const Object& obj = *vObjects[j];
+            const ObjectTransform& transform = objectTransforms[j];
+            obj.mesh->colliderBVH.Query(sweptBounds.Transformed(transform.worldToLocal), scratch.colliderRanges);
+            for (const ColliderBVH::Range& range : scratch.colliderRanges)
+            {
+                obj.mesh->colliders.SweepFirst(
+                    worldToUnit * transform.localToWorld, from, range.first, range.count, toi);
+            }
+        }
+    }
+
+    // Stop just short of the first hit, the discrete tests then resolve it
+    // against the side the physical came from
+    if (toi < 1.0f)
+    {
+        physical.pos = physical.prev_pos - back * toi;
+        job.stats.sweepHits += 1;
+    }
+}
+
+int64_t Engine::CollideRange(
+    PhysicsJob& job,
+    const Sphere& sphere,
+    Object& other,
+    const Matrix4& otherToWorld,
+    const ColliderSoA& colliders,
+    size_t first,
+    size_t count,
+    Matrix4& worldToUnit,
+    Matrix4& unitToWorld)
+{
+    // Brings point from collider's local coordinates to hits's local coordinates.
+    Physical& physical = *job.physical;
+    const Matrix4 localToUnit = worldToUnit * otherToWorld;
+    Vector3 push;
+    const int64_t hit = colliders.CollideFirst(localToUnit, first, count, push);
+    job.stats.colliderTests += (int64_t) (hit < 0 ? first + count : hit + 1) - (int64_t) first;
+    if (hit < 0)
+    {
+        return -1;
+    }
+
+    // If push is too small, just ignore
+    push = unitToWorld.MulDirection(push);
+    physical.OnCollide(other, push);
+    job.contacts.push_back({&other, push});
+
+    worldToUnit = sphere.LocalToUnit() * physical.WorldToLocal();
+    unitToWorld = worldToUnit.Inverse();
+    return hit;
+}
+
 void Engine::Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal)
 {
     // Basic global variables
@@ -329,7 +606,46 @@ void Engine::Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal)
     glDepthFunc(GL_LESS);
     glDepthMask(GL_TRUE);
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Number of portals this view is seen through
+    const int viewDepth = GH_MAX_RECURSION - GH_REC_LEVEL;
+    if (viewDepth == 0)
+    {
+        // Decide up front which views through portals fit in the budget
+        portalTree.Build(
+            cam, skipPortal, vPortals, GH_MAX_RECURSION - 1, args.portalPassBudget, args.portalPixelBudget);
+        renderNode = 0;
+        renderQueue.BeginFrame(vObjects);
+    }
+    else
+    {
+        // Texture mode views are cropped to their rectangle and rendered into
+        // a corner of a portal target, stencil mode ones into the screen
+        int x, y, w, h;
+        cam.ScissorRect(x, y, w, h);
+        renderStats.portalPasses += 1;
+        renderStats.portalPixels += (int64_t) w * h;
+        renderStats.targetPixels += (args.portalMode == PortalMode::TEXTURE) ? (int64_t) GH_FBO_SIZE * GH_FBO_SIZE
+                                                                             : (int64_t) cam.width * cam.height;
+    }
+
+    // In stencil mode views through portals share the target with the view
+    // they are seen in, only the outermost one clears it. Every view draws
+    // where the stencil matches its depth in the portal chain.
+    const bool stencil = (args.portalMode == PortalMode::STENCIL);
+    const bool outermost = (!stencil || viewDepth == 0);
+    if (stencil)
+    {
+        glEnable(GL_STENCIL_TEST);
+        glStencilMask(0xFF);
+        glStencilFunc(GL_EQUAL, viewDepth, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    }
+
+    if (outermost)
+    {
+        glClearStencil(0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | (stencil ? GL_STENCIL_BUFFER_BIT : 0));
+    }
     // Clear buffers
     if (GH_USE_SKY)
     {
@@ -337,20 +653,50 @@ void Engine::Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal)
         sky->Draw(cam);
     }
 
-    int clearValue = -1;
-    glClearBufferiv(GL_COLOR, 1, &clearValue);
+    if (outermost)
+    {
+        int clearValue = -1;
+        glClearBufferiv(GL_COLOR, 1, &clearValue);
+    }
 
-    // Create queries (if applicable)
-    GLuint queries[GH_MAX_PORTALS];
     GLuint drawTest[GH_MAX_PORTALS];
     assert(vPortals.size() <= GH_MAX_PORTALS);
-    if (occlusionCullingSupported)
+
+    // Draw scene, objects seen through a portal cannot be picked. Anything
+    // outside the view, or outside the portal it is seen through, is skipped.
+    // The rest is sorted by state, nested views only start after it is drawn.
+    const Frustum frustum(cam);
+    for (size_t i = 0; i < vObjects.size(); ++i)
     {
-        glGenQueries((GLsizei) vPortals.size(), queries);
+        Object& obj = *vObjects[i];
+        if (obj.mesh && obj.shader)
+        {
+            if (!obj.mesh->IsReady() || !obj.shader->IsReady() || (obj.texture && !obj.texture->IsReady()))
+            {
+                // Still loading, see AssetLoader
+                continue;
+            }
+            if (!frustum.Overlaps(obj.WorldBounds()))
+            {
+                renderStats.objectsCulled[viewDepth] += 1;
+                continue;
+            }
+            renderStats.objectsDrawn[viewDepth] += 1;
+            renderQueue.Add(obj, (int) i);
+        }
+        else
+        {
+            obj.Draw(cam, curFBO, outermost ? (int) i : -1);
+        }
+    }
+    renderQueue.Submit(cam, outermost);
+    for (size_t i = 0; i < vPortals.size(); ++i)
+    {
+        // Portals still loading are left out like the one seen through, see AssetLoader
+        const bool candidate = vPortals[i].get() != skipPortal && vPortals[i]->IsReady();
+        drawTest[i] = (candidate && frustum.Overlaps(vPortals[i]->WorldBounds())) ? 1 : 0;
+        renderStats.portalsCulled[viewDepth] += (candidate && !drawTest[i]) ? 1 : 0;
     }
-
-    // Draw scene
-    for (size_t i = 0; i < vObjects.size(); ++i) { vObjects[i]->Draw(cam, curFBO, i); }
 
     // Draw portals if possible
     if (GH_REC_LEVEL > 0)
@@ -359,45 +705,56 @@ void Engine::Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal)
         GH_REC_LEVEL -= 1;
         if (occlusionCullingSupported && GH_REC_LEVEL > 0)
         {
+            // Decide from earlier frames' results instead of waiting for this one's
             glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
             glDepthMask(GL_FALSE);
             for (size_t i = 0; i < vPortals.size(); ++i)
             {
-                if (vPortals[i].get() != skipPortal)
-                {
-                    glBeginQuery(GL_SAMPLES_PASSED, queries[i]);
-                    vPortals[i]->DrawPink(cam);
-                    glEndQuery(GL_SAMPLES_PASSED);
-                }
-            }
-            for (size_t i = 0; i < vPortals.size(); ++i)
-            {
-                if (vPortals[i].get() != skipPortal)
+                if (drawTest[i])
                 {
-                    glGetQueryObjectuiv(queries[i], GL_QUERY_RESULT, &drawTest[i]);
+                    drawTest[i] = portalQueries.Test(vPortals[i], renderView, cam) ? 1 : 0;
                 }
             }
             glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
             glDepthMask(GL_TRUE);
-            glDeleteQueries((GLsizei) vPortals.size(), queries);
         }
         for (size_t i = 0; i < vPortals.size(); ++i)
         {
-            if (vPortals[i].get() != skipPortal)
+            if (!drawTest[i])
+            {
+                continue;
+            }
+
+            // Views left out of the budget end the chain like the deepest ones do. So do
+            // views the tree does not know, which its uncropped cameras can disagree on near
+            // the edge of the visible rectangle
+            int node = -1;
+            if (GH_REC_LEVEL > 0)
             {
-                if (occlusionCullingSupported && (GH_REC_LEVEL > 0) && (drawTest[i] == 0))
+                node = portalTree.Child(renderNode, vPortals[i].get());
+                if (node < 0 || !portalTree.Get(node).rendered)
                 {
+                    vPortals[i]->DrawPink(cam);
                     continue;
                 }
-                else
-                {
-                    vPortals[i]->Draw(cam, curFBO, -1);
-                }
             }
+
+            const uint64_t parentView = renderView;
+            const int parentNode = renderNode;
+            renderView = (parentView ^ (uint64_t) (uintptr_t) vPortals[i].get()) * 0x100000001B3ull + 1;
+            renderNode = node;
+            vPortals[i]->Draw(cam, curFBO, -1);
+            renderView = parentView;
+            renderNode = parentNode;
         }
         GH_REC_LEVEL += 1;
     }
 
+    if (stencil && viewDepth == 0)
+    {
+        glDisable(GL_STENCIL_TEST);
+    }
+
 #if 0
   //Debug draw colliders
   for (size_t i = 0; i < vObjects.size(); ++i) {
@@ -428,6 +785,7 @@ void Engine::PickMouse()
     }
 }
 
+#ifndef GH_HEADLESS
 void Engine::CreateGLWindow()
 {
     // Always start in windowed mode
@@ -508,13 +866,21 @@ void Engine::InitGLObjects()
     // Check GL functionality
     glGetQueryiv(GL_SAMPLES_PASSED, GL_QUERY_COUNTER_BITS, &occlusionCullingSupported);
 
-    screenBuffer = std::make_shared<ScreenBuffer>(iWidth, iHeight);
+    const bool stencil = (args.portalMode == PortalMode::STENCIL);
+    screenBuffer = std::make_shared<ScreenBuffer>(iWidth, iHeight, stencil);
     minimap = std::make_shared<Minimap>();
 
+    // Only one portal per level renders at a time, so they can share targets.
+    // Portals drawn in place need none.
+    for (int i = 0; i < GH_MAX(GH_MAX_RECURSION - 1, 1) && !stencil; ++i)
+    {
+        portalTargets.push_back(std::make_unique<FrameBuffer>());
+    }
+
     if (args.enableVr)
     {
-        leftView = std::make_shared<FrameBuffer>(hmdWidth, hmdHeight);
-        rightView = std::make_shared<FrameBuffer>(hmdWidth, hmdHeight);
+        leftView = std::make_shared<FrameBuffer>(hmdWidth, hmdHeight, stencil);
+        rightView = std::make_shared<FrameBuffer>(hmdWidth, hmdHeight, stencil);
     }
 }
 
@@ -525,7 +891,11 @@ void Engine::DestroyGLObjects()
     vPortals.clear();
     screenBuffer.reset();
     minimap.reset();
+    portalTargets.clear();
+    portalQueries.Clear();
+    renderQueue.Clear();
 }
+#endif
 
 float Engine::NearestPortalDist() const
 {
@@ -542,6 +912,7 @@ void Engine::OnPlayerEnterRoom(const Vector3& previousPosition, const Vector3& n
     curScene->OnPlayerEnterRoom(player, previousPosition, vObjects, vPortals);
 }
 
+#ifndef GH_HEADLESS
 void Engine::ToggleFullscreen()
 {
     isFullscreen = !isFullscreen;
@@ -594,6 +965,8 @@ Matrix4 Engine::GetProjectionMatrix(vr::Hmd_Eye eye, float fNear, float fFar)
     }(HMD->GetProjectionMatrix(vr::Eye_Left, fNear, fFar));
 }
 
+#endif
+
 void Engine::ProcessPlayerMotion(const Matrix4& headMatrix)
 {
     // 1. Get new player physical position from HMD
@@ -613,11 +986,100 @@ void Engine::ProcessPlayerMotion(const Matrix4& headMatrix)
     player->pos = player->physicalPos + player->virtualOffsets;
 }
 
+void Engine::InterpolatePhysicals(float alpha)
+{
+    // prev_pos is where the last step started, teleports reset it so they snap
+    simulatedPositions.resize(vObjects.size());
+    for (size_t i = 0; i < vObjects.size(); ++i)
+    {
+        Physical* physical = vObjects[i]->AsPhysical();
+        simulatedPositions[i] = vObjects[i]->pos;
+        if (physical && !(args.enableVr && physical == player.get()))
+        {
+            physical->pos = physical->prev_pos + (physical->pos - physical->prev_pos) * alpha;
+        }
+    }
+}
+
+void Engine::RestorePhysicals()
+{
+    for (size_t i = 0; i < simulatedPositions.size() && i < vObjects.size(); ++i)
+    {
+        // The VR player moves with the headset while rendering, keep that
+        Physical* physical = vObjects[i]->AsPhysical();
+        if (physical && !(args.enableVr && physical == player.get()))
+        {
+            vObjects[i]->pos = simulatedPositions[i];
+        }
+    }
+}
+
+void Engine::ReportStats(double seconds, int64_t frames)
+{
+    const double steps = (double) GH_MAX(physicsStats.steps, (int64_t) 1);
+    const double numFrames = (double) GH_MAX(frames, (int64_t) 1);
+    printf("%.1f fps\n", frames / seconds);
+    printf(
+        "physics: %.1f steps/s, %.2f candidate pairs/step, %.1f collider tests/step, %zu objects\n",
+        physicsStats.steps / seconds, physicsStats.candidatePairs / steps, physicsStats.colliderTests / steps,
+        vObjects.size());
+    printf(
+        "physics: %d Hz, %lld steps dropped, %lld frames clamped, %lld sweeps, %lld sweep hits\n",
+        GH_MAX(args.physicsRate, 1), (long long) physicsStats.droppedSteps, (long long) physicsStats.clampedFrames,
+        (long long) physicsStats.sweeps, (long long) physicsStats.sweepHits);
+    printf("portals: %.3f tested/step of %zu\n", physicsStats.portalTests / steps, vPortals.size());
+    printf(
+        "transforms: %.1f recomputed/frame, %.1f recomputes avoided/frame\n",
+        (Object::transformCounts.recomputed + physicsStats.transforms.recomputed) / numFrames,
+        (Object::transformCounts.reused + physicsStats.transforms.reused) / numFrames);
+    printf("render targets: %.1f MB\n", FrameBuffer::allocatedBytes / (1024.0 * 1024.0));
+    printf(
+        "portal passes: %.1f/frame, %.1f%% of their targets' pixels\n", renderStats.portalPasses / numFrames,
+        100.0 * renderStats.portalPixels / GH_MAX(renderStats.targetPixels, (int64_t) 1));
+    printf(
+        "occlusion: %.1f stalls avoided/frame, %.1f portals culled/frame, %.1f without a result/frame\n",
+        portalQueries.stats.stallsAvoided / numFrames, portalQueries.stats.culled / numFrames,
+        portalQueries.stats.unknown / numFrames);
+    printf(
+        "portal tree: %.1f views/frame, %.1f rendered/frame, %.1f over budget/frame\n",
+        portalTree.stats.views / numFrames, portalTree.stats.rendered / numFrames,
+        portalTree.stats.overBudget / numFrames);
+    const RenderQueue::Stats& queue = renderQueue.stats;
+    printf(
+        "render queue: %.1f objects in %.1f draws/frame, %.1f program, %.1f texture, %.1f VAO switches/frame "
+        "(%.1f unsorted)\n",
+        queue.draws / numFrames, queue.batches / numFrames, queue.programSwitches / numFrames,
+        queue.textureSwitches / numFrames, queue.vaoSwitches / numFrames, queue.unsortedSwitches / numFrames);
+    printf("render data: %.1f KB uploaded/frame\n", queue.uploadedBytes / numFrames / 1024.0);
+    for (int level = 0; level <= GH_MAX_RECURSION; ++level)
+    {
+        const int64_t drawn = renderStats.objectsDrawn[level];
+        const int64_t culled = renderStats.objectsCulled[level];
+        if (drawn + culled > 0)
+        {
+            printf(
+                "level %d: %.1f objects drawn/frame, %.1f culled/frame, %.1f portals culled/frame\n", level,
+                drawn / numFrames, culled / numFrames, renderStats.portalsCulled[level] / numFrames);
+        }
+    }
+    physicsStats = PhysicsStats();
+    renderStats = RenderStats();
+    portalQueries.stats = PortalQueries::Stats();
+    portalTree.stats = PortalTree::Stats();
+    renderQueue.stats = RenderQueue::Stats();
+    Object::transformCounts = Object::TransformCounts();
+}
+
 bool Engine::TryPortals()
 {
-    for (auto& portal : vPortals)
+    // Only the portals near the player's motion can be crossed, they are
+    // tried in the same order as the full list
+    portalIndex.Sync(vPortals);
+    portalIndex.Query(player->prev_pos, player->pos, 2 * GH_NEAR_MIN * player->p_scale, portalCandidates);
+    physicsStats.portalTests += (int64_t) portalCandidates.size();
+    for (int i : portalCandidates)
     {
-        if (player->TryPortal(*portal))
+        if (player->TryPortal(*vPortals[i]))
         {
             return true;
         }
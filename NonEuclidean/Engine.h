@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include "AssetLoader.h"
+#include "BroadPhase.h"
 #include "Camera.h"
 #include "GameHeader.h"
 #include "InfiniteSpace.h"
@@ -10,12 +12,19 @@
 #include "Object.h"
 #include "Player.h"
 #include "Portal.h"
+#include "PortalIndex.h"
+#include "PortalQueries.h"
+#include "PortalTree.h"
+#include "RenderQueue.h"
 #include "ScreenBuffer.h"
 #include "Sky.h"
+#include "ThreadPool.h"
 #include "Timer.h"
 
-#include <GLFW/glfw3.h>
-#include <openvr.h>
+#ifndef GH_HEADLESS
+#    include <GLFW/glfw3.h>
+#    include <openvr.h>
+#endif
 
 #include <memory>
 #include <vector>
@@ -29,25 +38,114 @@ public:
     {
         bool enableVr = false;
         bool showMinimap = false;
+        bool showStats = false;
         int physicalSize = 16;
         int roomSize = 5;
+        int physicsThreads = 0; // 0 uses every hardware thread
+        int loaderThreads = 0;  // Threads reading and decoding assets, 0 uses every hardware thread
+        int physicsRate = GH_PHYSICS_RATE;
+        bool continuousCollision = true; // Sweep fast spheres so they cannot pass through thin colliders
+        PortalMode portalMode = PortalMode::TEXTURE;
+        int portalPassBudget = GH_PORTAL_PASS_BUDGET;     // Views through portals per rendered view
+        float portalPixelBudget = GH_PORTAL_PIXEL_BUDGET; // Screen area of those views, in screens
         RemovalStrategy removalStrategy = RemovalStrategy::IMMEDIATE;
     };
 
+    // Counters accumulated between two stats reports
+    struct PhysicsStats
+    {
+        int64_t steps = 0;
+        int64_t candidatePairs = 0;
+        int64_t colliderTests = 0;
+        int64_t droppedSteps = 0;  // Steps skipped to catch up with real time
+        int64_t clampedFrames = 0; // Frames that hit GH_MAX_STEPS
+        int64_t sweeps = 0;        // Hit spheres that moved far enough to be swept
+        int64_t sweepHits = 0;     // Sweeps that stopped a physical short of its step
+        int64_t portalTests = 0;   // Portals the player's motion was tested against
+        // Transform lookups of the narrow phase, on whichever thread ran it
+        Object::TransformCounts transforms;
+
+        PhysicsStats& operator+=(const PhysicsStats& other)
+        {
+            steps += other.steps;
+            candidatePairs += other.candidatePairs;
+            colliderTests += other.colliderTests;
+            droppedSteps += other.droppedSteps;
+            clampedFrames += other.clampedFrames;
+            sweeps += other.sweeps;
+            sweepHits += other.sweepHits;
+            portalTests += other.portalTests;
+            transforms.recomputed += other.transforms.recomputed;
+            transforms.reused += other.transforms.reused;
+            return *this;
+        }
+    };
+
+    // Render counters accumulated between two stats reports
+    struct RenderStats
+    {
+        int64_t portalPasses = 0; // Views rendered through portals
+        int64_t portalPixels = 0; // Pixels inside their scissor rectangles
+        int64_t targetPixels = 0; // Pixels of the targets they were rendered to, GH_FBO_SIZE squared in texture mode
+
+        // Per number of portals the view was seen through
+        int64_t objectsDrawn[GH_MAX_RECURSION + 1] = {};
+        int64_t objectsCulled[GH_MAX_RECURSION + 1] = {};
+        int64_t portalsCulled[GH_MAX_RECURSION + 1] = {};
+    };
+
     Engine(Args args);
     ~Engine();
 
+#ifndef GH_HEADLESS
     int Run();
+#endif
     void Update();
+    void Step();
     void Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal);
     void LoadScene(int ix);
     void PickMouse();
 
     const Player& GetPlayer() const { return *player; }
+    FrameBuffer& PortalTarget(int level) { return *portalTargets[level]; }
     float NearestPortalDist() const;
     void OnPlayerEnterRoom(const Vector3& previousPosition, const Vector3& currentPosition);
 
 private:
+    // A push that resolved a hit, the other object is told after the narrow phase
+    struct Contact
+    {
+        Object* other;
+        Vector3 push;
+    };
+
+    // Narrow phase work of one physical, filled in parallel
+    struct PhysicsJob
+    {
+        int objectIx;
+        Physical* physical;
+        std::vector<int> candidates;
+        std::vector<Contact> contacts;
+        PhysicsStats stats;
+    };
+
+    // Per thread query results
+    struct PhysicsScratch
+    {
+        std::vector<ColliderBVH::Range> colliderRanges;
+        std::vector<int> staticChunks;
+        std::vector<ColliderBVH::Range> chunkRanges;
+        std::vector<StaticWorld::Range> staticRanges;
+    };
+
+    // Transforms of the objects in the broad phase at the start of the narrow phase
+    struct ObjectTransform
+    {
+        Matrix4 localToWorld;
+        Matrix4 worldToLocal;
+    };
+
+#ifndef GH_HEADLESS
     void CreateGLWindow();
     void InitVR();
     void InitGLObjects();
@@ -56,15 +154,34 @@ private:
     Matrix4 GetHeadMatrix();
     Matrix4 GetEyeMatrix(vr::Hmd_Eye eye);
     Matrix4 GetProjectionMatrix(vr::Hmd_Eye eye, float fNear, float fFar);
+#endif
 
     void ProcessPlayerMotion(const Matrix4& headMatrix);
+    void InterpolatePhysicals(float alpha);
+    void RestorePhysicals();
     bool TryPortals();
+    void NarrowPhase(PhysicsJob& job, PhysicsScratch& scratch);
+    void Sweep(PhysicsJob& job, PhysicsScratch& scratch);
+    // Tests colliders [first, first + count) up to the first hit, which pushes the physical. Returns its index or -1
+    int64_t CollideRange(
+        PhysicsJob& job,
+        const Sphere& sphere,
+        Object& other,
+        const Matrix4& otherToWorld,
+        const ColliderSoA& colliders,
+        size_t first,
+        size_t count,
+        Matrix4& worldToUnit,
+        Matrix4& unitToWorld);
+    void ReportStats(double seconds, int64_t frames);
 
 public:
     Args args;
 
+#ifndef GH_HEADLESS
     GLFWwindow* window;
     vr::IVRSystem* HMD;
+#endif
 
     int iWidth;                   // window width
     int iHeight;                  // window height
@@ -73,6 +190,7 @@ public:
     std::shared_ptr<ScreenBuffer> screenBuffer;
     std::shared_ptr<Minimap> minimap;
     std::shared_ptr<FrameBuffer> leftView, rightView;
+    std::vector<std::unique_ptr<FrameBuffer>> portalTargets; // Shared by all portals, one per recursion level
 
     Matrix4 eyeMatrixLeft, eyeMatrixRight;
     Matrix4 projectionMatrixLeft, projectionMatrixRight;
@@ -88,6 +206,25 @@ public:
 
     GLint occlusionCullingSupported;
 
+    BroadPhase broadPhase;
+    PortalIndex portalIndex;
+    std::vector<int> portalCandidates;
+    PortalQueries portalQueries;
+    // Hash of the portals the view being rendered is seen through, starting from the view on the screen (0) or one of
+    // the eyes (1 and 2), so occlusion queries of different root views are kept apart
+    uint64_t renderView = 0;
+    PortalTree portalTree;
+    int renderNode = 0; // Node of the view being rendered in portalTree
+    RenderQueue renderQueue;
+    std::unique_ptr<ThreadPool> physicsPool;
+    std::unique_ptr<AssetLoader> assets;
+    std::vector<PhysicsJob> physicsJobs;
+    std::vector<PhysicsScratch> physicsScratch;
+    std::vector<ObjectTransform> objectTransforms;
+    std::vector<Vector3> simulatedPositions;
+    PhysicsStats physicsStats;
+    RenderStats renderStats;
+
     std::vector<std::shared_ptr<InfiniteSpace>> vScenes;
     std::shared_ptr<InfiniteSpace> curScene;
 };
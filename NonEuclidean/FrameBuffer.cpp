@@ -3,10 +3,15 @@
 
 #include <iostream>
 
-FrameBuffer::FrameBuffer(int width, int height)
+int64_t FrameBuffer::allocatedBytes = 0;
+
+FrameBuffer::FrameBuffer(int width, int height, bool stencil)
     : width(width)
     , height(height)
+    , stencil(stencil)
 {
+#ifndef GH_HEADLESS
+    allocatedBytes += MemoryBytes();
     glGenTextures(1, &texId);
     glBindTexture(GL_TEXTURE_2D, texId);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
@@ -21,9 +26,10 @@ FrameBuffer::FrameBuffer(int width, int height)
     //-------------------------
     glGenRenderbuffers(1, &renderBuf);
     glBindRenderbuffer(GL_RENDERBUFFER, renderBuf);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, height, height);
+    glRenderbufferStorage(GL_RENDERBUFFER, stencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, height, height);
     //-------------------------
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderBuf);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderBuf);
     //-------------------------
 
     // Does the GPU support current FBO configuration?
@@ -35,6 +41,20 @@ FrameBuffer::FrameBuffer(int width, int height)
 
     // Unbind so future rendering can proceed normally
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#else
+    // Nothing to render to without a GL context
+    texId = fbo = renderBuf = 0;
+#endif
+}
+
+FrameBuffer::~FrameBuffer()
+{
+#ifndef GH_HEADLESS
+    glDeleteRenderbuffers(1, &renderBuf);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texId);
+    allocatedBytes -= MemoryBytes();
+#endif
 }
 
 void FrameBuffer::Use()
@@ -45,7 +65,13 @@ void FrameBuffer::Use()
 void FrameBuffer::Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal)
 {
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glViewport(0, 0, GH_FBO_SIZE, GH_FBO_SIZE);
+    cam.UseViewport();
+    if (cam.visible.IsFull() && (cam.width < width || cam.height < height))
+    {
+        // Views smaller than the target only clear their own corner
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, 0, cam.width, cam.height);
+    }
     GH_ENGINE->Render(cam, fbo, skipPortal);
     glBindFramebuffer(GL_FRAMEBUFFER, curFBO);
 }
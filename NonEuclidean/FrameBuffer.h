@@ -11,16 +11,28 @@ class Portal;
 class FrameBuffer
 {
 public:
-    FrameBuffer(int width = GH_FBO_SIZE, int height = GH_FBO_SIZE);
+    // A stencil buffer is only needed when portals are drawn in place, see PortalMode
+    FrameBuffer(int width = GH_FBO_SIZE, int height = GH_FBO_SIZE, bool stencil = false);
+    ~FrameBuffer();
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
 
     void Render(const Camera& cam, GLuint curFBO, const Portal* skipPortal);
     void Use();
     void Bind();
     auto TexId() const { return texId; }
 
+    // Estimated GPU memory of one target: RGB8 color, stored as 4 bytes per texel, and 16-bit depth or
+    // 24-bit depth with 8-bit stencil
+    int64_t MemoryBytes() const { return (int64_t) width * height * (4 + (stencil ? 4 : 2)); }
+
+    // Estimated GPU memory held by all live frame buffers
+    static int64_t allocatedBytes;
+
 private:
     GLuint texId;
     GLuint fbo;
     GLuint renderBuf;
     int width, height;
+    bool stencil;
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "AABB.h"
+#include "Camera.h"
+#include "Vector.h"
+
+// Planes bounding the part of the world a camera can see
+class Frustum
+{
+public:
+    /**
+     * Planes of the camera's projection, with the sides narrowed to its
+     * visible rectangle. The near plane of a portal camera is the oblique
+     * plane through the portal, so nothing in front of it is kept.
+     */
+    explicit Frustum(const Camera& cam)
+    {
+        const Matrix4 m = cam.Matrix();
+        const Vector4 r0(m.m[0], m.m[1], m.m[2], m.m[3]);
+        const Vector4 r1(m.m[4], m.m[5], m.m[6], m.m[7]);
+        const Vector4 r2(m.m[8], m.m[9], m.m[10], m.m[11]);
+        const Vector4 r3(m.m[12], m.m[13], m.m[14], m.m[15]);
+        planes[0] = r0 - r3 * cam.visible.x0;
+        planes[1] = r3 * cam.visible.x1 - r0;
+        planes[2] = r1 - r3 * cam.visible.y0;
+        planes[3] = r3 * cam.visible.y1 - r1;
+        planes[4] = r3 + r2;
+        planes[5] = r3 - r2;
+    }
+
+    // False only if the box is entirely outside one of the planes
+    bool Overlaps(const AABB& box) const
+    {
+        if (box.IsEmpty())
+        {
+            return false;
+        }
+        for (const Vector4& p : planes)
+        {
+            // Corner of the box furthest along the plane's normal
+            const float x = (p.x >= 0.0f ? box.max.x : box.min.x);
+            const float y = (p.y >= 0.0f ? box.max.y : box.min.y);
+            const float z = (p.z >= 0.0f ? box.max.z : box.min.z);
+            if (p.x * x + p.y * y + p.z * z + p.w < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    Vector4 planes[6];
+};
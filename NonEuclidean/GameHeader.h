@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <stdint.h>
 
 // Windows
@@ -22,8 +23,12 @@ static const float GH_FOV = 60.0f;
 static const float GH_NEAR_MIN = 1e-3f;
 static const float GH_NEAR_MAX = 1e-1f;
 static const float GH_FAR = 100.0f;
-static const int GH_FBO_SIZE = 2048;
+static const int GH_FBO_SIZE = 2048; // Size of portal targets, and the largest view rendered into them
+static const int GH_FBO_MIN_SIZE = 64; // Smallest view rendered into a portal target
+static const float GH_FBO_LEVEL_SCALE = 0.75f; // Resolution of nested portal views, relative to their parent
 static const int GH_MAX_RECURSION = 4;
+static const int GH_PORTAL_PASS_BUDGET = 32;
+static const float GH_PORTAL_PIXEL_BUDGET = 3.0f; // In screens
 static const int GH_MINIMAP_SIZE = 200;
 
 // Gameplay
@@ -35,21 +40,32 @@ static const float GH_BOB_FREQ = 8.0f;
 static const float GH_BOB_OFFS = 0.015f;
 static const float GH_BOB_DAMP = 0.04f;
 static const float GH_BOB_MIN = 0.1f;
-static const float GH_DT = 0.002f;
+static const int GH_PHYSICS_RATE = 500; // Default steps per second, see GH_DT
+static const float GH_DT_TUNED = 0.002f; // Step length drag and friction were tuned for
 static const int GH_MAX_STEPS = 30;
+static const float GH_SWEEP_MIN = 0.5f;   // Motion per step, relative to the radius, from which spheres are swept
+static const float GH_SWEEP_SKIN = 0.05f; // Overlap a swept sphere stops at, relative to its radius
+static const int GH_SWEEP_ITERATIONS = 16;
+static const float GH_BROADPHASE_CELL = 4.0f;
+static const float GH_QUERY_SKIN = 1e-3f; // Growth of collider queries around a sphere, relative to its radius
 static const float GH_PLAYER_HEIGHT = 1.5f;
 static const float GH_PLAYER_RADIUS = 0.2f;
 static const float GH_GRAVITY = -9.8f;
 
 // Global variables
+class AssetLoader;
 class Engine;
 class Input;
 class Player;
 extern Engine* GH_ENGINE;
 extern Player* GH_PLAYER;
 extern const Input* GH_INPUT;
+extern AssetLoader* GH_ASSETS; // Loads assets in the background while the engine runs, see AquireMesh
 extern int GH_REC_LEVEL;
 extern int64_t GH_FRAME;
+extern float GH_DT; // Physics step length, set from the configured physics rate
+extern float GH_DT_SCALE;   // GH_DT / GH_DT_TUNED, set together with GH_DT
+extern float GH_BOB_RETAIN; // GH_STEP_RETAIN(GH_BOB_DAMP), set together with GH_DT
 
 // Functions
 template<class T>
@@ -67,3 +83,9 @@ inline T GH_MAX(T a, T b)
 {
     return a > b ? a : b;
 }
+
+// Fraction left after one step of something that loses the given fraction every GH_DT_TUNED
+inline float GH_STEP_RETAIN(float loss)
+{
+    return (GH_DT_SCALE == 1.0f) ? 1.0f - loss : std::pow(1.0f - loss, GH_DT_SCALE);
+}
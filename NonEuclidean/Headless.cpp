@@ -0,0 +1,665 @@
+#include "Engine.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "Physical.h"
+#include "Projectile.h"
+#include "Prop.h"
+#include "Resources.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string.h>
+
+// Allocation counters, the headless build replaces the global allocator to
+// see how much the simulation allocates per step
+static std::atomic<int64_t> numAllocs(0);
+static std::atomic<int64_t> numAllocBytes(0);
+
+void* operator new(size_t size)
+{
+    numAllocs.fetch_add(1, std::memory_order_relaxed);
+    numAllocBytes.fetch_add((int64_t) size, std::memory_order_relaxed);
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+struct HeadlessArgs
+{
+    int steps = 20000;
+    int queries = 100000;
+    int props = 0;
+    int projectiles = 1024;
+    int loads = 20;
+    int physicsRate = 0; // 0 keeps the rate of the benchmark
+    unsigned seed = 1;
+    const char* bench = "scene";
+};
+
+// Steps between two scripted door clicks
+static const int HEADLESS_DOOR_INTERVAL = 1500;
+// Steps after which the player gives up on a point it cannot reach
+static const int HEADLESS_WAYPOINT_TIMEOUT = 2000;
+
+// Every bundled mesh, for the mesh loading benchmarks
+static const char* HEADLESS_MESHES[] = {
+    "box.obj", "bunny.obj", "corridor-c.obj", "corridor-u.obj", "corridor.obj", "door.obj", "double_quad.obj",
+    "floorplan.obj", "ground.obj", "ground_slope.obj", "pillar.obj", "pillar_room.obj", "quad.obj",
+    "simple_room.obj", "square_rooms.obj", "suzanne.obj", "teapot.obj", "tunnel.obj", "tunnel_scale.obj",
+    "tunnel_slope.obj", "wall.obj", "woorden_door.obj"};
+// Largest difference between the pushes of the collider tests and the matrix based one, relative to their length
+static const float HEADLESS_PUSH_EPSILON = 1e-4f;
+// Entries of the FIFO vertex cache the cache miss ratios are measured with
+static const int HEADLESS_VERTEX_CACHE = 16;
+
+// Thin walls of the tunnelling benchmark, and how long projectiles fly at them
+static const int HEADLESS_WALLS = 64;
+static const float HEADLESS_FLIGHT_SECONDS = 1.0f;
+
+// Finds the room the player is standing in, or null when it is in a corridor
+static std::shared_ptr<Room> CurrentRoom(Engine& engine)
+{
+    const Player& player = engine.GetPlayer();
+    const int physicalSize = engine.curScene->GetPhysicalSize();
+    if (std::abs(player.pos.x) >= physicalSize / 2)
+    {
+        return nullptr;
+    }
+    const int index = (int) std::round(player.pos.z / physicalSize);
+    for (size_t i = 0; i < engine.vObjects.size(); ++i)
+    {
+        auto room = std::dynamic_pointer_cast<Room>(engine.vObjects[i]);
+        if (room && (int) std::round(room->pos.z / physicalSize) == index)
+        {
+            return room;
+        }
+    }
+    return nullptr;
+}
+
+// Opens a door of the room the player is standing in, like clicking on it
+static void OpenDoor(Engine& engine, const Room& room)
+{
+    for (const auto& door : room.doors)
+    {
+        if (door)
+        {
+            std::shared_ptr<Door> clicked = door;
+            engine.curScene->OnDoorClicked(clicked, engine.vObjects, engine.vPortals, *engine.player);
+            return;
+        }
+    }
+}
+
+/**
+ * Walks the player between random points of the room it is in. Room walls
+ * have no colliders, so the points keep it on the floor, and the pillar is
+ * often in the way. Every now and then a door is opened so corridors and
+ * portals get placed.
+ */
+static int BenchScene(const Engine::Args& engineArgs, const HeadlessArgs& args)
+{
+    srand(args.seed);
+    Engine engine(engineArgs);
+
+    // Props wander around the first room
+    const float propRange = engineArgs.roomSize * 0.5f - 0.5f;
+    for (int i = 0; i < args.props; ++i)
+    {
+        engine.vObjects.push_back(std::make_shared<Prop>(Vector3(0.0f, 0.1f, 0.0f), propRange, args.seed + i));
+    }
+
+    std::mt19937 rng(args.seed);
+    std::uniform_real_distribution<float> unit(-0.5f, 0.5f);
+    Vector3 waypoint = engine.GetPlayer().pos;
+    int waypointStep = 0;
+    float heading = 0.0f;
+
+    // Only allocations made by the simulation count, not the scripted clicks
+    int64_t allocs = 0;
+    int64_t bytes = 0;
+    Timer timer;
+    for (int step = 0; step < args.steps; ++step)
+    {
+        const std::shared_ptr<Room> room = CurrentRoom(engine);
+        const Vector3& pos = engine.GetPlayer().pos;
+        Vector3 delta = waypoint - pos;
+        delta.y = 0.0f;
+        if (room && (delta.MagSq() < 0.01f || step - waypointStep > HEADLESS_WAYPOINT_TIMEOUT))
+        {
+            // Pick a new point, away from the walls
+            const float extent = room->size - 1.0f;
+            waypoint = room->pos + Vector3(unit(rng) * extent, 0.0f, unit(rng) * extent);
+            waypointStep = step;
+        }
+        if (room && step % HEADLESS_DOOR_INTERVAL == HEADLESS_DOOR_INTERVAL - 1)
+        {
+            OpenDoor(engine, *room);
+        }
+
+        // Turn towards the point, the mouse moves the camera by a fixed angle per unit
+        float turn = heading - std::atan2(-delta.x, -delta.z);
+        turn -= std::round(turn / (2 * GH_PI)) * (2 * GH_PI);
+        engine.input.mouse_dx = turn / GH_MOUSE_SENSITIVITY;
+        engine.input.key['W'] = true;
+        heading -= turn;
+        heading -= std::round(heading / (2 * GH_PI)) * (2 * GH_PI);
+
+        const int64_t allocsBefore = numAllocs.load(std::memory_order_relaxed);
+        const int64_t bytesBefore = numAllocBytes.load(std::memory_order_relaxed);
+        engine.Step();
+        allocs += numAllocs.load(std::memory_order_relaxed) - allocsBefore;
+        bytes += numAllocBytes.load(std::memory_order_relaxed) - bytesBefore;
+    }
+    const double seconds = timer.GetSeconds();
+
+    const Engine::PhysicsStats& stats = engine.physicsStats;
+    const double steps = (double) GH_MAX(stats.steps, (int64_t) 1);
+    printf(
+        "scene: %d steps in %.3f s, %.1f steps/s, %.1fx real time at %d Hz\n", args.steps, seconds,
+        args.steps / seconds, args.steps * GH_DT / seconds, engineArgs.physicsRate);
+    printf(
+        "physics: %.2f candidate pairs/step, %.1f collider tests/step, %zu objects, %zu portals\n",
+        stats.candidatePairs / steps, stats.colliderTests / steps, engine.vObjects.size(), engine.vPortals.size());
+    printf("portals: %.3f tested/step\n", stats.portalTests / steps);
+    printf("allocations: %.3f/step, %.1f bytes/step\n", allocs / steps, bytes / steps);
+    const Vector3& end = engine.GetPlayer().pos;
+    printf("player: %.4f %.4f %.4f\n", end.x, end.y, end.z);
+
+    // Hash of where every physical ended up, equal for runs that simulated the same
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < engine.vObjects.size(); ++i)
+    {
+        const Physical* physical = engine.vObjects[i]->AsPhysical();
+        if (physical)
+        {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&physical->pos);
+            for (size_t b = 0; b < sizeof(physical->pos); ++b) { hash = (hash ^ bytes[b]) * 16777619u; }
+        }
+    }
+    printf("state: %08x (%d threads)\n", hash, engine.physicsPool->NumThreads());
+    return 0;
+}
+
+/**
+ * Fires small fast projectiles at thin walls, far away from the rooms, and
+ * counts the ones that end up behind their wall. Runs once with discrete
+ * collisions only and once with swept spheres.
+ */
+static int BenchTunnelling(Engine::Args engineArgs, const HeadlessArgs& args)
+{
+    engineArgs.physicsRate = (args.physicsRate > 0 ? args.physicsRate : 60);
+    int tunnelled = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        engineArgs.continuousCollision = (pass == 1);
+        srand(args.seed);
+        Engine engine(engineArgs);
+        std::mt19937 rng(args.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        // Each wall is a single zero thickness quad, 1 wide and 3 high, turned a bit
+        std::vector<std::shared_ptr<Object>> walls;
+        for (int i = 0; i < HEADLESS_WALLS; ++i)
+        {
+            std::shared_ptr<Object> wall = std::make_shared<Object>();
+            wall->mesh = AquireMesh("wall.obj");
+            wall->pos = Vector3((i % 8) * 4.0f, 100.0f, 1000.0f + (i / 8) * 10.0f);
+            wall->euler.y = (unit(rng) - 0.5f) * GH_PI / 3;
+            engine.vObjects.push_back(wall);
+            engine.curScene->staticWorld.Add(*wall);
+            walls.push_back(wall);
+        }
+
+        // Projectiles start 3 in front of a wall and fly at it at 20 to 60 per second
+        std::vector<std::shared_ptr<Projectile>> projectiles;
+        for (int i = 0; i < args.projectiles; ++i)
+        {
+            const Object& wall = *walls[i % walls.size()];
+            const Vector3 aim(unit(rng) * 0.8f - 0.4f, unit(rng) * 2.6f + 0.2f, 0.0f);
+            const Vector3 start = aim + Vector3(unit(rng) - 0.5f, unit(rng) - 0.5f, -3.0f);
+            const Vector3 velocity = (aim - start).Normalized() * (20.0f + unit(rng) * 40.0f);
+            projectiles.push_back(std::make_shared<Projectile>(
+                wall.LocalToWorld().MulPoint(start), wall.LocalToWorld().MulDirection(velocity), 0.05f));
+            engine.vObjects.push_back(projectiles.back());
+        }
+
+        const int steps = (int) std::ceil(HEADLESS_FLIGHT_SECONDS / GH_DT);
+        Timer timer;
+        for (int step = 0; step < steps; ++step) { engine.Step(); }
+        const double seconds = timer.GetSeconds();
+
+        int passed = 0;
+        for (int i = 0; i < args.projectiles; ++i)
+        {
+            const Object& wall = *walls[i % walls.size()];
+            passed += (wall.WorldToLocal().MulPoint(projectiles[i]->pos).z > 0.0f ? 1 : 0);
+        }
+        const Engine::PhysicsStats& stats = engine.physicsStats;
+        printf(
+            "%-10s %d of %d projectiles passed through at %d Hz, %.3f ms/step, %lld sweeps, %lld sweep hits\n",
+            pass == 1 ? "continuous" : "discrete", passed, args.projectiles, engineArgs.physicsRate,
+            seconds * 1e3 / steps, (long long) stats.sweeps, (long long) stats.sweepHits);
+        tunnelled = passed;
+    }
+    return tunnelled > 0 ? 1 : 0;
+}
+
+/**
+ * The matrix based test colliders used before they were stored as a center
+ * and half axes, kept to check the new tests against.
+ */
+static bool ReferenceCollide(const Collider& collider, const Matrix4& localToUnit, Vector3& delta)
+{
+    Matrix4 mat;
+    mat.MakeIdentity();
+    mat.SetTranslation(collider.Center());
+    mat.SetXAxis(collider.AxisX());
+    mat.SetYAxis(collider.AxisY());
+
+    const Matrix4 local = localToUnit * mat;
+    const Vector3 v = -local.Translation();
+    const Vector3 x = local.XAxis();
+    const Vector3 y = local.YAxis();
+    const float px = GH_CLAMP(v.Dot(x) / x.MagSq(), -1.0f, 1.0f);
+    const float py = GH_CLAMP(v.Dot(y) / y.MagSq(), -1.0f, 1.0f);
+    const Vector3 closest = x * px + y * py;
+    delta = v - closest;
+    if (delta.MagSq() >= 1.0f)
+    {
+        return false;
+    }
+    delta = delta.Normalized() - delta;
+    return true;
+}
+
+/**
+ * Tests small spheres at random places inside a mesh against its colliders:
+ * one by one, in SIMD batches, and through the hierarchy. Returns how many
+ * spheres got other hits or pushes from the batched test than from
+ * ReferenceCollide.
+ */
+static int BenchMeshColliders(const char* name, const std::shared_ptr<Mesh>& mesh, const HeadlessArgs& args)
+{
+    const ColliderSoA& colliders = mesh->colliders;
+    const AABB& bounds = mesh->bounds;
+
+    std::mt19937 rng(args.seed);
+    std::uniform_real_distribution<float> rx(bounds.min.x, bounds.max.x);
+    std::uniform_real_distribution<float> ry(bounds.min.y, bounds.max.y);
+    std::uniform_real_distribution<float> rz(bounds.min.z, bounds.max.z);
+    const Vector3 halfSize = bounds.HalfSize();
+    const float radius = 0.05f * GH_MAX(halfSize.x, GH_MAX(halfSize.y, halfSize.z));
+    std::vector<Matrix4> unitToLocal(args.queries);
+    for (int i = 0; i < args.queries; ++i)
+    {
+        unitToLocal[i] = Matrix4::Trans(Vector3(rx(rng), ry(rng), rz(rng))) * Matrix4::Scale(radius);
+    }
+
+    // Visits every collider of every range, like the narrow phase does
+    std::vector<ColliderBVH::Range> ranges;
+    enum Mode
+    {
+        Scalar,
+        Batched,
+        Hierarchy,
+    };
+    auto run = [&](Mode mode, const char* label) {
+        int64_t tests = 0;
+        int64_t hits = 0;
+        Timer timer;
+        for (int i = 0; i < args.queries; ++i)
+        {
+            const Matrix4 localToUnit = unitToLocal[i].Inverse();
+            if (mode == Hierarchy)
+            {
+                mesh->colliderBVH.Query(AABB::OfUnitSphere(unitToLocal[i]), ranges);
+            }
+            else
+            {
+                ranges.assign(1, {0, (uint32_t) colliders.Size()});
+            }
+            for (const ColliderBVH::Range& range : ranges)
+            {
+                size_t c = range.first;
+                const size_t end = range.first + range.count;
+                while (c < end)
+                {
+                    Vector3 push;
+                    const int64_t hit = (mode == Scalar) ? colliders.CollideFirstScalar(localToUnit, c, end - c, push)
+                                                         : colliders.CollideFirst(localToUnit, c, end - c, push);
+                    tests += (hit < 0 ? end : hit + 1) - c;
+                    if (hit < 0)
+                    {
+                        break;
+                    }
+                    hits += 1;
+                    c = (size_t) hit + 1;
+                }
+            }
+        }
+        const double seconds = timer.GetSeconds();
+        printf(
+            "  %-10s %8.1f ns/query, %8.1f tests/query, %lld hits\n", label, seconds * 1e9 / args.queries,
+            (double) tests / args.queries, (long long) hits);
+    };
+
+    // Every hit, in order, with the push the matrix based test gives
+    int mismatches = 0;
+    float maxError = 0.0f;
+    std::vector<std::pair<size_t, Vector3>> expected;
+    for (int i = 0; i < args.queries; ++i)
+    {
+        const Matrix4 localToUnit = unitToLocal[i].Inverse();
+        expected.clear();
+        for (size_t c = 0; c < colliders.Size(); ++c)
+        {
+            Vector3 push;
+            if (ReferenceCollide(colliders.Get(c), localToUnit, push))
+            {
+                expected.push_back({c, push});
+            }
+        }
+        size_t numHits = 0;
+        bool same = true;
+        size_t c = 0;
+        while (c < colliders.Size())
+        {
+            Vector3 push;
+            const int64_t hit = colliders.CollideFirst(localToUnit, c, colliders.Size() - c, push);
+            if (hit < 0)
+            {
+                break;
+            }
+            if (numHits < expected.size() && expected[numHits].first == (size_t) hit)
+            {
+                const Vector3& ref = expected[numHits].second;
+                const float error = (push - ref).Mag() / GH_MAX(ref.Mag(), 1.0f);
+                maxError = GH_MAX(maxError, error);
+                same = same && error <= HEADLESS_PUSH_EPSILON;
+            }
+            else
+            {
+                same = false;
+            }
+            numHits += 1;
+            c = (size_t) hit + 1;
+        }
+        mismatches += (same && numHits == expected.size()) ? 0 : 1;
+    }
+
+    printf("%s: %zu colliders, %zu nodes\n", name, colliders.Size(), mesh->colliderBVH.NumNodes());
+    run(Scalar, "scalar");
+    run(Batched, "batched");
+    run(Hierarchy, "hierarchy");
+    printf(
+        "  reference  %d of %d queries differ from the matrix based test, largest push error %g\n", mismatches,
+        args.queries, maxError);
+    return mismatches;
+}
+
+static int BenchColliders(const HeadlessArgs& args)
+{
+    static const char* meshes[] = {"pillar_room.obj", "square_rooms.obj", "floorplan.obj", "tunnel.obj"};
+    int mismatches = 0;
+    for (const char* name : meshes) { mismatches += BenchMeshColliders(name, AquireMesh(name), args); }
+
+    // A generated corridor with a turn at every point, like the ones placed between rooms
+    const std::vector<Vector3> points = {
+        Vector3(0, 0, -2.5f), Vector3(0, 0, -6), Vector3(5, 0, -6), Vector3(5, 0, 4), Vector3(2.5f, 0, 4)};
+    std::shared_ptr<Mesh> part1, part2;
+    Side connectionSide;
+    CreateCorridorMesh(points, part1, part2, Side::North, Side::East, connectionSide);
+    mismatches += BenchMeshColliders("corridor part 1", part1, args);
+    mismatches += BenchMeshColliders("corridor part 2", part2, args);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// True if both meshes hold exactly the same vertices, UVs, normals, indices, colliders and hierarchy size
+static bool SameMesh(const Mesh& a, const Mesh& b)
+{
+    auto sameFloats = [](const std::vector<float>& x, const std::vector<float>& y) {
+        return x.size() == y.size() && (x.empty() || memcmp(x.data(), y.data(), x.size() * sizeof(float)) == 0);
+    };
+    auto sameVector = [](const Vector3& x, const Vector3& y) { return memcmp(&x, &y, sizeof(Vector3)) == 0; };
+    if (!sameFloats(a.Verts(), b.Verts()) || !sameFloats(a.Uvs(), b.Uvs()) || !sameFloats(a.Normals(), b.Normals())
+        || a.Indices() != b.Indices() || a.colliders.Size() != b.colliders.Size()
+        || a.colliderBVH.NumNodes() != b.colliderBVH.NumNodes() || a.Format().posType != b.Format().posType
+        || a.Format().uvType != b.Format().uvType || a.Format().stride != b.Format().stride)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.colliders.Size(); ++i)
+    {
+        const Collider ca = a.colliders.Get(i);
+        const Collider cb = b.colliders.Get(i);
+        if (!sameVector(ca.Center(), cb.Center()) || !sameVector(ca.AxisX(), cb.AxisX())
+            || !sameVector(ca.AxisY(), cb.AxisY()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Loads every bundled mesh with the memory mapped reader, the string
+ * stream one and from its baked file, and checks that all of them
+ * produce the same mesh. Meshes that are not baked, or whose baked file is
+ * stale, are read from the OBJ file in the baked column.
+ */
+static int BenchMeshes(const HeadlessArgs& args)
+{
+    const int loads = GH_MAX(args.loads, 1);
+    auto run = [&](const char* name, ObjReader reader, double& ms, double& allocs) {
+        const int64_t allocsBefore = numAllocs.load();
+        Timer timer;
+        for (int i = 0; i < loads; ++i) { Mesh mesh(name, reader); }
+        ms = timer.GetSeconds() * 1e3 / loads;
+        allocs = (double) (numAllocs.load() - allocsBefore) / loads;
+    };
+
+    double totalStream = 0.0;
+    double totalMapped = 0.0;
+    double totalBaked = 0.0;
+    int mismatches = 0;
+    printf(
+        "%-18s %10s %10s %10s %8s %12s %12s %12s\n", "mesh", "stream ms", "mapped ms", "baked ms", "speedup",
+        "stream allocs", "mapped allocs", "baked allocs");
+    for (const char* name : HEADLESS_MESHES)
+    {
+        const Mesh mapped(name, ObjReader::MAPPED);
+        const bool same =
+            SameMesh(Mesh(name, ObjReader::STREAM), mapped) && SameMesh(Mesh(name, ObjReader::BAKED), mapped);
+        mismatches += same ? 0 : 1;
+        double streamMs, mappedMs, bakedMs, streamAllocs, mappedAllocs, bakedAllocs;
+        run(name, ObjReader::STREAM, streamMs, streamAllocs);
+        run(name, ObjReader::MAPPED, mappedMs, mappedAllocs);
+        run(name, ObjReader::BAKED, bakedMs, bakedAllocs);
+        totalStream += streamMs;
+        totalMapped += mappedMs;
+        totalBaked += bakedMs;
+        printf(
+            "%-18s %10.3f %10.3f %10.3f %7.1fx %12.0f %12.0f %12.0f%s\n", name, streamMs, mappedMs, bakedMs,
+            streamMs / GH_MAX(bakedMs, 1e-6), streamAllocs, mappedAllocs, bakedAllocs, same ? "" : "  MISMATCH");
+    }
+    printf(
+        "total: %.2f ms with string streams, %.2f ms memory mapped, %.2f ms baked, %d mismatches\n", totalStream,
+        totalMapped, totalBaked, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * Loads every bundled mesh as triangle soup, welded in file order and
+ * optimized for the vertex cache, and compares the average number of
+ * vertices transformed per triangle. Sizes are of float soup, of float
+ * vertices with indices and of the packed vertices the GPU gets.
+ */
+static int BenchVertexCache()
+{
+    size_t totalSoup = 0;
+    size_t totalIndexed = 0;
+    size_t totalPacked = 0;
+    double totalTris = 0.0;
+    double totalWelded = 0.0;
+    double totalOptimized = 0.0;
+    printf(
+        "%-18s %8s %8s %10s %10s %10s %6s %8s %8s %8s\n", "mesh", "tris", "verts", "soup KB", "indexed KB",
+        "packed KB", "stride", "soup", "welded", "optimized");
+    for (const char* name : HEADLESS_MESHES)
+    {
+        const Mesh soup(name, ObjReader::MAPPED, MeshLayout::SOUP);
+        const Mesh welded(name, ObjReader::MAPPED, MeshLayout::WELDED);
+        const Mesh optimized(name, ObjReader::MAPPED, MeshLayout::OPTIMIZED);
+        auto acmr = [](const Mesh& mesh) {
+            return AverageCacheMissRatio(mesh.Indices(), mesh.NumVertices(), HEADLESS_VERTEX_CACHE);
+        };
+        auto floatBytes = [](const Mesh& mesh) {
+            return (mesh.Verts().size() + mesh.Uvs().size() + mesh.Normals().size()) * sizeof(float);
+        };
+        const size_t tris = soup.Indices().size() / 3;
+        const size_t soupBytes = floatBytes(soup);
+        const size_t packedBytes = optimized.GPUBytes();
+        const size_t indexedBytes =
+            floatBytes(optimized) + packedBytes - optimized.NumVertices() * optimized.Format().stride;
+        totalSoup += soupBytes;
+        totalIndexed += indexedBytes;
+        totalPacked += packedBytes;
+        totalTris += (double) tris;
+        totalWelded += acmr(welded) * tris;
+        totalOptimized += acmr(optimized) * tris;
+        printf(
+            "%-18s %8zu %8zu %10.1f %10.1f %10.1f %6d %8.3f %8.3f %8.3f\n", name, tris, optimized.NumVertices(),
+            soupBytes / 1024.0, indexedBytes / 1024.0, packedBytes / 1024.0, (int) optimized.Format().stride,
+            acmr(soup), acmr(welded), acmr(optimized));
+    }
+    printf(
+        "total: %.1f KB as soup, %.1f KB indexed, %.1f KB packed, ACMR %.3f welded, %.3f optimized (%d entry FIFO)\n",
+        totalSoup / 1024.0, totalIndexed / 1024.0, totalPacked / 1024.0, totalWelded / GH_MAX(totalTris, 1.0),
+        totalOptimized / GH_MAX(totalTris, 1.0), HEADLESS_VERTEX_CACHE);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Engine::Args engineArgs;
+    engineArgs.showStats = true; // Reporting is all the headless binary does
+    HeadlessArgs args;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0)
+        {
+            args.steps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--queries") == 0)
+        {
+            args.queries = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            args.seed = (unsigned) atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--props") == 0)
+        {
+            args.props = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--loads") == 0)
+        {
+            args.loads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--projectiles") == 0)
+        {
+            args.projectiles = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            engineArgs.physicsThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--loaderThreads") == 0)
+        {
+            engineArgs.loaderThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--discreteCollision") == 0)
+        {
+            engineArgs.continuousCollision = false;
+        }
+        else if (strcmp(argv[i], "--physicsRate") == 0)
+        {
+            engineArgs.physicsRate = atoi(argv[++i]);
+            args.physicsRate = engineArgs.physicsRate;
+        }
+        else if (strcmp(argv[i], "--bench") == 0)
+        {
+            args.bench = argv[++i];
+        }
+        else if (strcmp(argv[i], "--physicalSize") == 0)
+        {
+            engineArgs.physicalSize = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--roomSize") == 0)
+        {
+            engineArgs.roomSize = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--removalStrategy") == 0)
+        {
+            if (strcmp(argv[++i], "immediate") == 0)
+            {
+                engineArgs.removalStrategy = RemovalStrategy::IMMEDIATE;
+            }
+            else if (strcmp(argv[i], "keep_one") == 0)
+            {
+                engineArgs.removalStrategy = RemovalStrategy::KEEP_ONE;
+            }
+            else
+            {
+                printf("Warning: Invalid removal strategy: %s. Must be one of \"immediate\", \"keep_one\".\n", argv[i]);
+            }
+        }
+        else
+        {
+            printf("Warning: Invalid argument: %s\n", argv[i]);
+        }
+    }
+
+    if (strcmp(args.bench, "scene") == 0)
+    {
+        return BenchScene(engineArgs, args);
+    }
+    else if (strcmp(args.bench, "colliders") == 0)
+    {
+        return BenchColliders(args);
+    }
+    else if (strcmp(args.bench, "tunnelling") == 0)
+    {
+        return BenchTunnelling(engineArgs, args);
+    }
+    else if (strcmp(args.bench, "meshes") == 0)
+    {
+        return BenchMeshes(args);
+    }
+    else if (strcmp(args.bench, "vertexCache") == 0)
+    {
+        return BenchVertexCache();
+    }
+    printf(
+        "Unknown benchmark: %s. Must be one of \"scene\", \"colliders\", \"tunnelling\", \"meshes\", "
+        "\"vertexCache\".\n",
+        args.bench);
+    return 1;
+}
@@ -13,7 +13,7 @@ constexpr int ROOMTYPE_START = 0;
 constexpr int ROOMTYPE_TARGET = 1;
 constexpr int ROOMTYPE_2 = 2;
 
-static auto CreateCorridorMesh(
+void CreateCorridorMesh(
     const std::vector<Vector3>& points,
     std::shared_ptr<Mesh>& part1,
     std::shared_ptr<Mesh>& part2,
@@ -467,6 +467,14 @@ InfiniteSpace::InfiniteSpace(int physicalSize, int roomSize, RemovalStrategy rem
     roomTypes.push_back({.texture = AquireTexture("stonetiles.bmp"), .hasTarget = false});
     roomTypes.push_back({.texture = AquireTexture("ParchmentWallpaper.bmp"), .hasTarget = true});
     roomTypes.push_back({.texture = AquireTexture("ParchmentWallpaper.bmp"), .hasTarget = false});
+
+    // Start loading everything rooms and the portals between them are made of, so it loads in parallel before
+    // the first room or door click needs it
+    meshes = {
+        AquireMesh("box.obj"), AquireMesh("door.obj"), AquireMesh("pillar.obj"), AquireMesh("bunny.obj"),
+        AquireMesh("double_quad.obj")};
+    shaders = {AquireShader("texture"), AquireShader("color"), AquireShader("portal"), AquireShader("pink")};
+    targetTexture = AquireTexture("gold.bmp");
 }
 
 void Room::PlaceDoor(std::shared_ptr<Door>& door, Side side)
@@ -528,6 +536,7 @@ auto Room::GetDoorPhysicalPos(Side side) const -> Vector3
 
 void InfiniteSpace::Load(PObjectVec& objs, PPortalVec& portals, Player& player)
 {
+    staticWorld.Clear();
     GenerateNode(ROOMTYPE_START, 0);
     PlaceRoom(objs, 0);
 
@@ -597,12 +606,14 @@ void InfiniteSpace::OnDoorClicked(std::shared_ptr<Door>& door, PObjectVec& objs,
     }
 
     // remove door
+    staticWorld.Remove(*door);
     objs.erase(std::remove_if(objs.begin(), objs.end(), [&](auto& it) { return it == door; }), objs.end());
     currentRoom->doors[door->side] = nullptr;
 }
 
 void InfiniteSpace::OnTargetClicked(std::shared_ptr<Target>& target, PObjectVec& objs, Player& player)
 {
+    staticWorld.Remove(*target);
     objs.erase(std::remove(objs.begin(), objs.end(), target));
 
     auto& currentNode = nodes[std::round(player.pos.z / physicalSize)];
@@ -656,6 +667,7 @@ void InfiniteSpace::OnPlayerEnterRoom(
             auto door = std::make_shared<Door>(-1, (int) side, ROOM_COLORS[lastRoomIndex % ROOM_COLORS.size()]);
             nodes[currentRoomIndex].room->PlaceDoor(door, side);
             objs.push_back(door);
+            staticWorld.Add(*door);
         }
     }
 }
@@ -750,6 +762,7 @@ auto InfiniteSpace::PlaceRoom(PObjectVec& objs, int nodeIndex, int entranceSide)
         room->physicalPos.z = (rand() % a) - (a / 2.0f);
         room->pos += room->physicalPos;
     }
+    staticWorld.Add(*room);
 
     // place doors
     for (int side = 0; side < nodes[nodeIndex].connections.size(); side++)
@@ -761,6 +774,7 @@ auto InfiniteSpace::PlaceRoom(PObjectVec& objs, int nodeIndex, int entranceSide)
             auto door = std::make_shared<Door>(connection, side, ROOM_COLORS[connection % ROOM_COLORS.size()]);
             room->PlaceDoor(door, (Side) side);
             objs.push_back(door);
+            staticWorld.Add(*door);
         }
     }
 
@@ -769,6 +783,7 @@ auto InfiniteSpace::PlaceRoom(PObjectVec& objs, int nodeIndex, int entranceSide)
     pillar->pos.x = room->pos.x - 2.0f;
     pillar->pos.z = room->pos.z - 2.0f;
     objs.push_back(pillar);
+    staticWorld.Add(*pillar);
     room->pillar = pillar;
 
     // place target if this is a target room
@@ -778,6 +793,7 @@ auto InfiniteSpace::PlaceRoom(PObjectVec& objs, int nodeIndex, int entranceSide)
         target->pos.x = room->pos.x + 2.0f;
         target->pos.z = room->pos.z - 2.0f;
         objs.push_back(target);
+        staticWorld.Add(*target);
         room->target = target;
     }
 
@@ -807,6 +823,8 @@ void InfiniteSpace::PlaceCorridor(std::shared_ptr<Corridor>& corridor)
     corridor->part1->pos.z = physicalSize * i;
     corridor->part2->pos.x = physicalSize * 2;
     corridor->part2->pos.z = physicalSize * i;
+    staticWorld.Add(*corridor->part1);
+    staticWorld.Add(*corridor->part2);
 }
 
 bool InfiniteSpace::IsValidNode(int nodeIndex)
@@ -857,6 +875,19 @@ void InfiniteSpace::RemoveRoom(int index, PObjectVec& objs, PPortalVec& portals)
     const auto& room = nodes[index].room;
 
     // 1. remove door, room and target objects
+    for (const auto& door : room->doors)
+    {
+        if (door)
+        {
+            staticWorld.Remove(*door);
+        }
+    }
+    staticWorld.Remove(*room);
+    staticWorld.Remove(*room->pillar);
+    if (room->target)
+    {
+        staticWorld.Remove(*room->target);
+    }
     objs.erase(
         std::remove_if(
             objs.begin(), objs.end(),
@@ -883,6 +914,8 @@ void InfiniteSpace::RemoveRoom(int index, PObjectVec& objs, PPortalVec& portals)
 void InfiniteSpace::RemoveCorridor(std::shared_ptr<Corridor>& corridor, PObjectVec& objs, PPortalVec& portals)
 {
     // 1. remove corridor object
+    staticWorld.Remove(*corridor->part1);
+    staticWorld.Remove(*corridor->part2);
     objs.erase(
         std::remove_if(
             objs.begin(), objs.end(), [&](auto& it) { return it == corridor->part1 || it == corridor->part2; }),
@@ -930,6 +963,7 @@ void InfiniteSpace::CloseCorridor(
         auto door = std::make_shared<Door>(roomToDelete, (int) side, ROOM_COLORS[roomToDelete % ROOM_COLORS.size()]);
         currentRoom->PlaceDoor(door, side);
         objs.push_back(door);
+        staticWorld.Add(*door);
     }
     else
     {
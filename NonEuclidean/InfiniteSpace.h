@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Scene.h"
+#include "StaticWorld.h"
 
 #include <array>
 
@@ -96,6 +97,19 @@ public:
     Vector3 physicalPos;
 };
 
+/**
+ * Builds the two halves of a corridor along axis aligned points, cut at the
+ * middle point so it may overlap with itself. connectionSide is set to the
+ * side the first half leaves the middle point through.
+ */
+void CreateCorridorMesh(
+    const std::vector<Vector3>& points,
+    std::shared_ptr<Mesh>& part1,
+    std::shared_ptr<Mesh>& part2,
+    Side entranceSide,
+    Side exitSide,
+    Side& connectionSide);
+
 struct Corridor
 {
     Corridor(
@@ -162,6 +176,9 @@ public:
     int GetPhysicalSize() const { return physicalSize; };
     void CreateFloorplanVertices(const Player& player, std::vector<float>& vertices) const;
 
+    /** Colliders of the rooms, doors, pillars, targets and corridors that are placed */
+    StaticWorld staticWorld;
+
 private:
     /**
      * Places a room node in virtual space.
@@ -186,6 +203,9 @@ private:
     int nextNode = 1;
     RemovalStrategy removalStrategy;
     std::vector<RoomType> roomTypes;
+    std::vector<std::shared_ptr<Mesh>> meshes; // What rooms are built from, kept loaded while rooms come and go
+    std::vector<std::shared_ptr<Shader>> shaders;
+    std::shared_ptr<Texture> targetTexture;
     std::vector<Node> nodes;
     std::vector<std::shared_ptr<Corridor>> activeCorridors;
 };
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <memory>
 
+#ifndef GH_HEADLESS
 void Input::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     auto input = static_cast<Input*>(glfwGetWindowUserPointer(window));
@@ -34,12 +35,14 @@ void Input::CursorCallback(GLFWwindow* window, double x, double y)
     input->mouse_x = x;
     input->mouse_y = y;
 }
+#endif
 
 Input::Input()
 {
     memset(this, 0, sizeof(Input));
 }
 
+#ifndef GH_HEADLESS
 void Input::SetupCallbacks(GLFWwindow* window)
 {
     glfwSetWindowUserPointer(window, this);
@@ -51,6 +54,7 @@ void Input::SetupCallbacks(GLFWwindow* window)
     glfwSetMouseButtonCallback(window, ButtonCallback);
     glfwSetCursorPosCallback(window, CursorCallback);
 }
+#endif
 
 void Input::EndFrame()
 {
@@ -62,5 +66,7 @@ void Input::EndFrame()
 
 void Input::Update()
 {
+#ifndef GH_HEADLESS
     glfwPollEvents();
+#endif
 }
@@ -2,7 +2,14 @@
 
 #include <glad/glad.h>
 
-#include <GLFW/glfw3.h>
+#ifndef GH_HEADLESS
+#    include <GLFW/glfw3.h>
+#else
+// Key and button codes match GLFW, so scripted input uses the same indices
+#    define GLFW_KEY_LAST 348
+#    define GLFW_MOUSE_BUTTON_LAST 7
+struct GLFWwindow;
+#endif
 
 class Input
 {
@@ -15,6 +15,26 @@ int main(int argc, char* argv[])
         {
             args.showMinimap = true;
         }
+        else if (strcmp(argv[i], "--showStats") == 0)
+        {
+            args.showStats = true;
+        }
+        else if (strcmp(argv[i], "--physicsThreads") == 0)
+        {
+            args.physicsThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--loaderThreads") == 0)
+        {
+            args.loaderThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--discreteCollision") == 0)
+        {
+            args.continuousCollision = false;
+        }
+        else if (strcmp(argv[i], "--physicsRate") == 0)
+        {
+            args.physicsRate = atoi(argv[++i]);
+        }
         else if (strcmp(argv[i], "--physicalSize") == 0)
         {
             args.physicalSize = atoi(argv[++i]);
@@ -38,6 +58,29 @@ int main(int argc, char* argv[])
                 printf("Warning: Invalid removal strategy: %s. Must be one of \"immediate\", \"keep_one\".\n", argv[i]);
             }
         }
+        else if (strcmp(argv[i], "--portalMode") == 0)
+        {
+            if (strcmp(argv[++i], "texture") == 0)
+            {
+                args.portalMode = PortalMode::TEXTURE;
+            }
+            else if (strcmp(argv[i], "stencil") == 0)
+            {
+                args.portalMode = PortalMode::STENCIL;
+            }
+            else
+            {
+                printf("Warning: Invalid portal mode: %s. Must be one of \"texture\", \"stencil\".\n", argv[i]);
+            }
+        }
+        else if (strcmp(argv[i], "--portalPasses") == 0)
+        {
+            args.portalPassBudget = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--portalPixels") == 0)
+        {
+            args.portalPixelBudget = (float) atof(argv[++i]);
+        }
         else
         {
             printf("Warning: Invalid argument: %s\n", argv[i]);
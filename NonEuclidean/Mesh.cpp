@@ -1,224 +1,545 @@
 #include "Mesh.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "ObjScanner.h"
 #include "Vector.h"
 #include <cassert>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <numeric>
 #include <sstream>
 #include <string>
 
-Mesh::Mesh(const char* fname)
+/**
+ * Start of a baked mesh file, followed by the vertices, UVs, normals,
+ * indices, colliders, hierarchy nodes and the vertices packed in the
+ * VertexFormat of posType and uvType.
+ */
+struct BakedHeader
 {
-    // Open the file for reading
-    std::ifstream fin(std::string("NonEuclidean/Meshes/") + fname);
-    if (!fin)
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize; // Size and modification time of the OBJ file it was baked from
+    int64_t sourceTime;
+    uint32_t numVertices;
+    uint32_t uvSize;
+    uint32_t numIndices;
+    uint32_t numColliders;
+    uint32_t numNodes;
+    uint32_t posType;
+    uint32_t uvType;
+    uint32_t padding;
+    float bounds[6];
+};
+static const char BAKED_MAGIC[4] = {'G', 'H', 'M', 'B'};
+// Bump whenever the format or the way meshes are built changes, older files are then ignored
+static const uint32_t BAKED_VERSION = 2;
+
+static void PutVector(float* dst, const Vector3& v)
+{
+    dst[0] = v.x;
+    dst[1] = v.y;
+    dst[2] = v.z;
+}
+
+// 16 bit indices when every vertex can be addressed with them
+static GLenum IndexType(size_t numVertices)
+{
+    return (numVertices <= 0x10000) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+static std::string MeshPath(const char* fname)
+{
+    return std::string("NonEuclidean/Meshes/") + fname;
+}
+
+// Size and modification time of a file, false if it does not exist
+static bool SourceStamp(const std::string& path, uint64_t& size, int64_t& time)
+{
+    std::error_code error;
+    size = (uint64_t) std::filesystem::file_size(path, error);
+    if (error)
     {
-        return;
+        return false;
     }
+    time = (int64_t) std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    return !error;
+}
 
-    // Temporaries
-    std::vector<float> vert_palette;
-    std::vector<float> uv_palette;
-    bool is3DTex = false;
+Mesh::Mesh(const char* fname, ObjReader reader, MeshLayout layout)
+{
+    Load(fname, reader, layout);
+    Upload();
+}
+
+void Mesh::Load(const char* fname, ObjReader reader, MeshLayout layout)
+{
+    if (reader == ObjReader::BAKED)
+    {
+        if (layout == MeshLayout::OPTIMIZED && LoadBaked(fname))
+        {
+            return;
+        }
+        reader = ObjReader::MAPPED;
+    }
 
-    // Read the file
-    std::string line;
-    while (!fin.eof())
+    const std::string path = MeshPath(fname);
+    ObjState state;
+    if (reader == ObjReader::MAPPED)
     {
-        std::getline(fin, line);
-        if (line.find("v ") == 0)
+        // Lines are scanned in place, nothing is allocated per line
+        MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            return;
+        }
+        const char* p = file.Data();
+        const char* const end = p + file.Size();
+        while (p < end)
         {
-            std::stringstream ss(line.c_str() + 2);
-            float x, y, z;
-            ss >> x >> y >> z;
-            vert_palette.push_back(x);
-            vert_palette.push_back(y);
-            vert_palette.push_back(z);
+            const char* eol = (const char*) memchr(p, '\n', end - p);
+            eol = eol ? eol : end;
+            ParseObjLine<ObjScanner>(p, eol, state);
+            p = (eol < end) ? eol + 1 : end;
         }
-        else if (line.find("vt ") == 0)
+    }
+    else
+    {
+        std::ifstream fin(path);
+        if (!fin)
+        {
+            return;
+        }
+        std::string line;
+        while (!fin.eof())
+        {
+            std::getline(fin, line);
+            ParseObjLine<ObjStreamScanner>(line.data(), line.data() + line.size(), state);
+        }
+    }
+
+    SetupColliders(state.colliders);
+    SetupIndices(layout, state.is3DTex);
+    ComputeBounds();
+    SetupFormat(state.is3DTex);
+}
+
+template <typename Scanner>
+void Mesh::ParseObjLine(const char* line, const char* end, ObjState& state)
+{
+    std::vector<float>& vert_palette = state.vert_palette;
+    std::vector<float>& uv_palette = state.uv_palette;
+    const size_t length = end - line;
+    auto startsWith = [&](const char* prefix) {
+        const size_t n = strlen(prefix);
+        return length >= n && memcmp(line, prefix, n) == 0;
+    };
+    auto charAt = [&](size_t i) { return i < length ? line[i] : '\0'; };
+
+    if (startsWith("v "))
+    {
+        Scanner ss(line + 2, end, false);
+        float x, y, z;
+        ss >> x >> y >> z;
+        vert_palette.push_back(x);
+        vert_palette.push_back(y);
+        vert_palette.push_back(z);
+    }
+    else if (startsWith("vt "))
+    {
+        Scanner ss(line + 3, end, false);
+        float u, v, w;
+        ss >> u >> v >> w;
+        uv_palette.push_back(u);
+        uv_palette.push_back(v);
+        if (!ss.Fail())
+        {
+            uv_palette.push_back(w);
+            state.is3DTex = true;
+        }
+    }
+    else if (startsWith("c "))
+    {
+        uint32_t a = 0, b = 0, c = 0;
+        if (charAt(2) == '*')
+        {
+            const uint32_t v_ix = (uint32_t) vert_palette.size() / 3;
+            a = v_ix - 2;
+            b = v_ix - 1;
+            c = v_ix;
+        }
+        else
+        {
+            Scanner ss(line + 2, end, false);
+            ss >> a >> b >> c;
+        }
+        const Vector3 v1(&vert_palette[(a - 1) * 3]);
+        const Vector3 v2(&vert_palette[(b - 1) * 3]);
+        const Vector3 v3(&vert_palette[(c - 1) * 3]);
+        state.colliders.push_back(Collider(v1, v2, v3));
+    }
+    else if (startsWith("f "))
+    {
+        // Count the slashes, the scanner reads them as spaces
+        int num_slashes = 0;
+        size_t last_slash_ix = 0;
+        bool doubleslash = false;
+        for (size_t i = 0; i < length; ++i)
         {
-            std::stringstream ss(line.c_str() + 3);
-            float u, v, w;
-            ss >> u >> v >> w;
-            uv_palette.push_back(u);
-            uv_palette.push_back(v);
-            if (!ss.fail())
+            if (line[i] == '/')
             {
-                uv_palette.push_back(w);
-                is3DTex = true;
+                if (last_slash_ix == i - 1)
+                {
+                    assert(vert_palette.size() == uv_palette.size() || uv_palette.empty());
+                    doubleslash = true;
+                }
+                last_slash_ix = i;
+                num_slashes++;
             }
         }
-        else if (line.find("c ") == 0)
+        uint32_t a = 0, b = 0, c = 0, d = 0;
+        uint32_t at = 0, bt = 0, ct = 0, dt = 0;
+        uint32_t _tmp;
+        Scanner ss(line + 2, end, true);
+        const bool wild = (charAt(2) == '*');
+        const bool wild2 = (charAt(3) == '*');
+        bool isQuad = false;
+
+        // Interpret face based on slash
+        if (wild)
         {
-            uint32_t a = 0, b = 0, c = 0;
-            if (line[2] == '*')
+            assert(num_slashes == 0);
+            const uint32_t v_ix = (uint32_t) vert_palette.size() / 3;
+            const uint32_t t_ix = (uint32_t) uv_palette.size() / (state.is3DTex ? 3 : 2);
+            if (wild2)
+            {
+                a = v_ix - 3;
+                b = v_ix - 2;
+                c = v_ix - 1;
+                d = v_ix - 0;
+                at = t_ix - 3;
+                bt = t_ix - 2;
+                ct = t_ix - 1;
+                dt = t_ix - 0;
+                isQuad = true;
+            }
+            else
             {
-                const uint32_t v_ix = (uint32_t) vert_palette.size() / 3;
                 a = v_ix - 2;
                 b = v_ix - 1;
                 c = v_ix;
+                at = t_ix - 2;
+                bt = t_ix - 1;
+                ct = t_ix;
             }
-            else
+        }
+        else if (num_slashes == 0)
+        {
+            ss >> a >> b >> c >> d;
+            at = a;
+            bt = b;
+            ct = c;
+            dt = d;
+            if (!ss.Fail())
             {
-                std::stringstream ss(line.c_str() + 2);
-                ss >> a >> b >> c;
+                isQuad = true;
             }
-            const Vector3 v1(&vert_palette[(a - 1) * 3]);
-            const Vector3 v2(&vert_palette[(b - 1) * 3]);
-            const Vector3 v3(&vert_palette[(c - 1) * 3]);
-            colliders.push_back(Collider(v1, v2, v3));
         }
-        else if (line.find("f ") == 0)
+        else if (num_slashes == 3)
         {
-            // Count the slashes
-            int num_slashes = 0;
-            size_t last_slash_ix = 0;
-            bool doubleslash = false;
-            for (size_t i = 0; i < line.size(); ++i)
+            ss >> a >> at >> b >> bt >> c >> ct;
+        }
+        else if (num_slashes == 4)
+        {
+            isQuad = true;
+            ss >> a >> at >> b >> bt >> c >> ct >> d >> dt;
+        }
+        else if (num_slashes == 6)
+        {
+            if (doubleslash)
             {
-                if (line[i] == '/')
-                {
-                    line[i] = ' ';
-                    if (last_slash_ix == i - 1)
-                    {
-                        assert(vert_palette.size() == uv_palette.size() || uv_palette.empty());
-                        doubleslash = true;
-                    }
-                    last_slash_ix = i;
-                    num_slashes++;
-                }
+                ss >> a >> _tmp >> b >> _tmp >> c >> _tmp;
+                at = a;
+                bt = b;
+                ct = c;
             }
-            uint32_t a = 0, b = 0, c = 0, d = 0;
-            uint32_t at = 0, bt = 0, ct = 0, dt = 0;
-            uint32_t _tmp;
-            std::stringstream ss(line.c_str() + 2);
-            const bool wild = (line[2] == '*');
-            const bool wild2 = (line[3] == '*');
-            bool isQuad = false;
-
-            // Interpret face based on slash
-            if (wild)
+            else
             {
-                assert(num_slashes == 0);
-                const uint32_t v_ix = (uint32_t) vert_palette.size() / 3;
-                const uint32_t t_ix = (uint32_t) uv_palette.size() / (is3DTex ? 3 : 2);
-                if (wild2)
-                {
-                    a = v_ix - 3;
-                    b = v_ix - 2;
-                    c = v_ix - 1;
-                    d = v_ix - 0;
-                    at = t_ix - 3;
-                    bt = t_ix - 2;
-                    ct = t_ix - 1;
-                    dt = t_ix - 0;
-                    isQuad = true;
-                }
-                else
-                {
-                    a = v_ix - 2;
-                    b = v_ix - 1;
-                    c = v_ix;
-                    at = t_ix - 2;
-                    bt = t_ix - 1;
-                    ct = t_ix;
-                }
+                ss >> a >> at >> _tmp >> b >> bt >> _tmp >> c >> ct >> _tmp;
             }
-            else if (num_slashes == 0)
+        }
+        else if (num_slashes == 8)
+        {
+            isQuad = true;
+            if (doubleslash)
             {
-                ss >> a >> b >> c >> d;
+                ss >> a >> _tmp >> b >> _tmp >> c >> _tmp >> d >> _tmp;
                 at = a;
                 bt = b;
                 ct = c;
                 dt = d;
-                if (!ss.fail())
-                {
-                    isQuad = true;
-                }
-            }
-            else if (num_slashes == 3)
-            {
-                ss >> a >> at >> b >> bt >> c >> ct;
-            }
-            else if (num_slashes == 4)
-            {
-                isQuad = true;
-                ss >> a >> at >> b >> bt >> c >> ct >> d >> dt;
-            }
-            else if (num_slashes == 6)
-            {
-                if (doubleslash)
-                {
-                    ss >> a >> _tmp >> b >> _tmp >> c >> _tmp;
-                    at = a;
-                    bt = b;
-                    ct = c;
-                }
-                else
-                {
-                    ss >> a >> at >> _tmp >> b >> bt >> _tmp >> c >> ct >> _tmp;
-                }
-            }
-            else if (num_slashes == 8)
-            {
-                isQuad = true;
-                if (doubleslash)
-                {
-                    ss >> a >> _tmp >> b >> _tmp >> c >> _tmp >> d >> _tmp;
-                    at = a;
-                    bt = b;
-                    ct = c;
-                    dt = d;
-                }
-                else
-                {
-                    ss >> a >> at >> _tmp >> b >> bt >> _tmp >> c >> ct >> _tmp >> d >> dt >> _tmp;
-                }
             }
             else
             {
-                assert(false);
-                continue;
+                ss >> a >> at >> _tmp >> b >> bt >> _tmp >> c >> ct >> _tmp >> d >> dt >> _tmp;
             }
+        }
+        else
+        {
+            assert(false);
+            return;
+        }
 
-            // Add face to list
-            AddFace(vert_palette, uv_palette, a, at, b, bt, c, ct, is3DTex);
-            if (isQuad)
-            {
-                AddFace(vert_palette, uv_palette, c, ct, d, dt, a, at, is3DTex);
-            }
+        // Add face to list
+        AddFace(vert_palette, uv_palette, a, at, b, bt, c, ct, state.is3DTex);
+        if (isQuad)
+        {
+            AddFace(vert_palette, uv_palette, c, ct, d, dt, a, at, state.is3DTex);
         }
     }
-
-    SetupGL(is3DTex);
 }
 
 Mesh::Mesh(
     const std::vector<float>& verts,
     const std::vector<float>& uvs,
     const std::vector<float>& normals,
-    const std::vector<Collider>& colliders)
+    const std::vector<Collider>& colliders,
+    MeshLayout layout)
     : verts(verts)
     , uvs(uvs)
     , normals(normals)
-    , colliders(colliders)
 {
-    SetupGL(false);
+    std::vector<Collider> collider_list = colliders;
+    SetupColliders(collider_list);
+    SetupIndices(layout, false);
+    ComputeBounds();
+    SetupFormat(false);
+    Upload();
+}
+
+std::string Mesh::BakedPath(const char* fname)
+{
+    std::string path = MeshPath(fname);
+    const size_t dot = path.find_last_of('.');
+    return path.substr(0, (dot == std::string::npos) ? path.size() : dot) + ".mesh";
+}
+
+bool Mesh::Bake(const char* fname) const
+{
+    if (uvs.size() != NumVertices() * format.uvSize || normals.size() != verts.size())
+    {
+        return false;
+    }
+    BakedHeader header = {};
+    memcpy(header.magic, BAKED_MAGIC, sizeof(header.magic));
+    header.version = BAKED_VERSION;
+    if (!SourceStamp(MeshPath(fname), header.sourceSize, header.sourceTime))
+    {
+        return false;
+    }
+    header.numVertices = (uint32_t) NumVertices();
+    header.uvSize = (uint32_t) format.uvSize;
+    header.numIndices = (uint32_t) indices.size();
+    header.numColliders = (uint32_t) colliders.Size();
+    header.numNodes = (uint32_t) colliderBVH.NumNodes();
+    header.posType = format.posType;
+    header.uvType = format.uvType;
+    PutVector(&header.bounds[0], bounds.min);
+    PutVector(&header.bounds[3], bounds.max);
+
+    std::ofstream fout(BakedPath(fname), std::ios::binary);
+    auto write = [&](const void* data, size_t bytes) { fout.write((const char*) data, (std::streamsize) bytes); };
+    write(&header, sizeof(header));
+    write(verts.data(), verts.size() * sizeof(float));
+    write(uvs.data(), uvs.size() * sizeof(float));
+    write(normals.data(), normals.size() * sizeof(float));
+    write(indices.data(), indices.size() * sizeof(uint32_t));
+    for (size_t i = 0; i < colliders.Size(); ++i)
+    {
+        const Collider c = colliders.Get(i);
+        float axes[9];
+        PutVector(&axes[0], c.Center());
+        PutVector(&axes[3], c.AxisX());
+        PutVector(&axes[6], c.AxisY());
+        write(axes, sizeof(axes));
+    }
+    for (const ColliderBVH::Node& node : colliderBVH.Nodes())
+    {
+        float box[6];
+        PutVector(&box[0], node.bounds.min);
+        PutVector(&box[3], node.bounds.max);
+        write(box, sizeof(box));
+        write(&node.first, sizeof(node.first));
+        write(&node.count, sizeof(node.count));
+    }
+    std::vector<uint8_t> vertexData;
+    format.Pack(verts, uvs, normals, vertexData);
+    write(vertexData.data(), vertexData.size());
+    return (bool) fout;
+}
+
+bool Mesh::LoadBaked(const char* fname)
+{
+    std::unique_ptr<MappedFile> mapped(new MappedFile(BakedPath(fname)));
+    const MappedFile& file = *mapped;
+    BakedHeader header;
+    if (!file.IsOpen() || file.Size() < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, file.Data(), sizeof(header));
+    VertexFormat bakedFormat;
+    if (memcmp(header.magic, BAKED_MAGIC, sizeof(header.magic)) != 0 || header.version != BAKED_VERSION
+        || !VertexFormat::FromTypes(header.posType, header.uvType, (int) header.uvSize, bakedFormat))
+    {
+        return false;
+    }
+
+    // Stale once the OBJ file changed, without it the baked mesh is all there is
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (SourceStamp(MeshPath(fname), sourceSize, sourceTime)
+        && (sourceSize != header.sourceSize || sourceTime != header.sourceTime))
+    {
+        return false;
+    }
+
+    const size_t colliderBytes = 9 * sizeof(float);
+    const size_t nodeBytes = 6 * sizeof(float) + 2 * sizeof(uint32_t);
+    const size_t expected = sizeof(header) + (size_t) header.numVertices * (6 + header.uvSize) * sizeof(float)
+                            + (size_t) header.numIndices * sizeof(uint32_t) + header.numColliders * colliderBytes
+                            + header.numNodes * nodeBytes + (size_t) header.numVertices * bakedFormat.stride;
+    if (file.Size() != expected)
+    {
+        return false;
+    }
+
+    // Everything is copied straight out of the mapping, nothing is parsed
+    std::vector<uint32_t> bakedIndices(header.numIndices);
+    const char* p = file.Data() + sizeof(header);
+    auto read = [&p](void* data, size_t bytes) {
+        memcpy(data, p, bytes);
+        p += bytes;
+    };
+    const char* const vertexData = p;
+    p += (size_t) header.numVertices * (6 + header.uvSize) * sizeof(float);
+    read(bakedIndices.data(), bakedIndices.size() * sizeof(uint32_t));
+    for (uint32_t index : bakedIndices)
+    {
+        if (index >= header.numVertices)
+        {
+            return false;
+        }
+    }
+
+    std::vector<Collider> list;
+    list.reserve(header.numColliders);
+    for (uint32_t i = 0; i < header.numColliders; ++i)
+    {
+        float axes[9];
+        read(axes, sizeof(axes));
+        list.push_back(Collider::FromAxes(Vector3(&axes[0]), Vector3(&axes[3]), Vector3(&axes[6])));
+    }
+    std::vector<ColliderBVH::Node> nodes(header.numNodes);
+    for (ColliderBVH::Node& node : nodes)
+    {
+        float box[6];
+        read(box, sizeof(box));
+        node.bounds.min = Vector3(&box[0]);
+        node.bounds.max = Vector3(&box[3]);
+        read(&node.first, sizeof(node.first));
+        read(&node.count, sizeof(node.count));
+    }
+
+    // Leaves must stay within the colliders and inner nodes point at two later nodes, so queries always end
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const ColliderBVH::Node& node = nodes[i];
+        const bool valid = (node.count > 0) ? (uint64_t) node.first + node.count <= header.numColliders
+                                            : node.first > i && (uint64_t) node.first + 1 < header.numNodes;
+        if (!valid)
+        {
+            return false;
+        }
+    }
+
+    // Only now that the file checks out, so a failed load leaves the mesh empty for the OBJ reader
+    p = vertexData;
+    verts.resize((size_t) header.numVertices * 3);
+    uvs.resize((size_t) header.numVertices * header.uvSize);
+    normals.resize((size_t) header.numVertices * 3);
+    read(verts.data(), verts.size() * sizeof(float));
+    read(uvs.data(), uvs.size() * sizeof(float));
+    read(normals.data(), normals.size() * sizeof(float));
+    indices = std::move(bakedIndices);
+    colliders.Assign(list);
+    colliderBVH.Assign(std::move(nodes));
+
+    bounds.min = Vector3(&header.bounds[0]);
+    bounds.max = Vector3(&header.bounds[3]);
+    format = bakedFormat;
+    indexType = IndexType(NumVertices());
+    bakedVertices = (const uint8_t*) file.Data() + file.Size() - (size_t) header.numVertices * format.stride;
+    bakedFile = std::move(mapped);
+    return true;
 }
 
 Mesh::~Mesh()
 {
-    glDeleteBuffers(NUM_VBOS, vbo);
+#ifndef GH_HEADLESS
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
     glDeleteVertexArrays(1, &vao);
+#endif
 }
 
 void Mesh::Draw()
 {
+    Bind();
+    DrawBound();
+}
+
+void Mesh::Bind()
+{
+    glBindVertexArray(vao);
+}
+
+void Mesh::DrawBound()
+{
+    glDrawElements(GL_TRIANGLES, (GLsizei) indices.size(), indexType, 0);
+}
+
+void Mesh::BindInstanced(GLuint instanceBuffer)
+{
+    static const GLuint INSTANCE_BINDING = 1;
     glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei) verts.size() / 3);
+    if (!instanceAttribs)
+    {
+        // Only enabled once a buffer is attached, so plain draws never read it
+        glVertexAttribIFormat(3, 1, GL_INT, 0);
+        glVertexAttribBinding(3, INSTANCE_BINDING);
+        glEnableVertexAttribArray(3);
+        glVertexBindingDivisor(INSTANCE_BINDING, 1);
+        instanceAttribs = true;
+    }
+    glBindVertexBuffer(INSTANCE_BINDING, instanceBuffer, 0, sizeof(Instance));
+}
+
+void Mesh::DrawInstanced(GLsizei count, GLuint first)
+{
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, (GLsizei) indices.size(), indexType, 0, count, first);
+}
+
+size_t Mesh::GPUBytes() const
+{
+    const size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+    return NumVertices() * format.stride + indices.size() * indexSize;
 }
 
 void Mesh::DebugDraw(const Camera& cam, const Matrix4& objMat)
 {
-    for (size_t i = 0; i < colliders.size(); ++i) { colliders[i].DebugDraw(cam, objMat); }
+    for (size_t i = 0; i < colliders.Size(); ++i) { colliders.Get(i).DebugDraw(cam, objMat); }
 }
 
 void Mesh::AddFace(
@@ -285,28 +606,89 @@ void Mesh::AddFace(
     }
 }
 
-void Mesh::SetupGL(bool is3DTex)
+void Mesh::SetupColliders(std::vector<Collider>& list)
+{
+    // The hierarchy reorders the list so its leaves are contiguous ranges
+    colliderBVH.Build(list);
+    colliders.Assign(list);
+}
+
+void Mesh::SetupIndices(MeshLayout layout, bool is3DTex)
 {
+    const size_t uvSize = is3DTex ? 3 : 2;
+    const size_t count = verts.size() / 3;
+    if (layout == MeshLayout::SOUP || uvs.size() != count * uvSize || normals.size() != count * 3)
+    {
+        indices.resize(count);
+        std::iota(indices.begin(), indices.end(), 0);
+    }
+    else
+    {
+        WeldVertices(verts, uvs, normals, uvSize, indices);
+        if (layout == MeshLayout::OPTIMIZED)
+        {
+            OptimizeVertexCache(indices, verts.size() / 3);
+            OptimizeVertexFetch(verts, uvs, normals, uvSize, indices);
+        }
+    }
+}
+
+void Mesh::ComputeBounds()
+{
+    bounds = AABB();
+    for (size_t i = 0; i + 2 < verts.size(); i += 3) { bounds.Extend(Vector3(&verts[i])); }
+    for (size_t i = 0; i < colliders.Size(); ++i) { bounds.Extend(colliders.Get(i).Bounds()); }
+}
+
+void Mesh::SetupFormat(bool is3DTex)
+{
+    format = VertexFormat::Choose(verts, uvs, is3DTex ? 3 : 2);
+    indexType = IndexType(NumVertices());
+}
+
+void Mesh::Upload()
+{
+    ready = true;
+    // Only the CPU side data is used without a GL context
+#ifndef GH_HEADLESS
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
 
-    glGenBuffers(NUM_VBOS, vbo);
+    std::vector<uint8_t> vertexData;
+    if (!bakedVertices)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-        glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(verts[0]), verts.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        format.Pack(verts, uvs, normals, vertexData);
     }
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(
+        GL_ARRAY_BUFFER, NumVertices() * format.stride, bakedVertices ? bakedVertices : vertexData.data(),
+        GL_STATIC_DRAW);
+    glVertexAttribFormat(0, 3, format.posType, GL_FALSE, 0);
+    glVertexAttribFormat(1, format.uvSize, format.uvType, format.uvType == GL_UNSIGNED_SHORT, format.uvOffset);
+    glVertexAttribFormat(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, format.normalOffset);
+    for (GLuint attrib = 0; attrib < 3; ++attrib)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(uvs[0]), uvs.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, (is3DTex ? 3 : 2), GL_FLOAT, GL_FALSE, 0, 0);
+        glVertexAttribBinding(attrib, 0);
+        glEnableVertexAttribArray(attrib);
     }
+    glBindVertexBuffer(0, vbo, 0, format.stride);
+
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    if (indexType == GL_UNSIGNED_SHORT)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-        glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(normals[0]), normals.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
     }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    }
+#endif
+
+    // The packed vertices are on the GPU now
+    bakedVertices = nullptr;
+    bakedFile.reset();
 }
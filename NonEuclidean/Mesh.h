@@ -1,32 +1,110 @@
 #pragma once
+#include "AABB.h"
 #include "Camera.h"
 #include "Collider.h"
+#include "ColliderBVH.h"
+#include "ColliderSoA.h"
+#include "MappedFile.h"
+#include "VertexFormat.h"
 
 #include <glad/glad.h>
 
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
+// How Mesh reads OBJ files
+enum class ObjReader
+{
+    MAPPED, // Maps the file into memory and scans the numbers in place
+    STREAM, // Reads it line by line through string streams, kept to compare against
+    BAKED,  // Maps the baked binary mesh, see Mesh::Bake, and falls back to MAPPED when it is missing or stale
+};
+
+// How Mesh lays out its vertices and triangles
+enum class MeshLayout
+{
+    SOUP,      // Three vertices per triangle, indexed in order
+    WELDED,    // Identical vertices merged, triangles in file order
+    OPTIMIZED, // Welded, with triangles reordered for the vertex cache and vertices in order of use
+};
+
 class Mesh
 {
 public:
-    static const int NUM_VBOS = 3;
+    // Per instance data of instanced draws, at attribute location 3: the index of the object being drawn
+    typedef int32_t Instance;
 
-    Mesh(const char* fname);
+    // Mesh that is filled in later by Load and Upload, see AquireMesh
+    Mesh() {}
+    Mesh(const char* fname, ObjReader reader = ObjReader::BAKED, MeshLayout layout = MeshLayout::OPTIMIZED);
     Mesh(
         const std::vector<float>& verts,
         const std::vector<float>& uvs,
         const std::vector<float>& normals,
-        const std::vector<Collider>& colliders);
+        const std::vector<Collider>& colliders,
+        MeshLayout layout = MeshLayout::OPTIMIZED);
     ~Mesh();
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // The two halves of loading from a file: Load does not touch GL and may run on any thread, Upload makes it drawable
+    void Load(const char* fname, ObjReader reader = ObjReader::BAKED, MeshLayout layout = MeshLayout::OPTIMIZED);
+    void Upload();
+    bool IsReady() const { return ready; }
+
+    /**
+     * Writes the mesh next to the OBJ file it was loaded from, in the binary
+     * format ObjReader::BAKED reads. The file records the size and time of
+     * the OBJ file, so it is not used anymore once that changes.
+     */
+    bool Bake(const char* fname) const;
+
+    // Path of the baked mesh of the given OBJ file
+    static std::string BakedPath(const char* fname);
 
     void Draw();
 
+    // Draw in two steps, so meshes drawn several times in a row are only bound once
+    void Bind();
+    void DrawBound();
+
+    // Binds the mesh with its instances read from the given buffer, see Instance
+    void BindInstanced(GLuint instanceBuffer);
+    void DrawInstanced(GLsizei count, GLuint first);
+
     void DebugDraw(const Camera& cam, const Matrix4& objMat);
 
-    std::vector<Collider> colliders;
+    const std::vector<float>& Verts() const { return verts; }
+    const std::vector<float>& Uvs() const { return uvs; }
+    const std::vector<float>& Normals() const { return normals; }
+    const std::vector<uint32_t>& Indices() const { return indices; }
+    size_t NumVertices() const { return verts.size() / 3; }
+
+    const VertexFormat& Format() const { return format; }
+
+    // Size of the vertex and index buffers on the GPU
+    size_t GPUBytes() const;
+
+    ColliderSoA colliders;
+    ColliderBVH colliderBVH;
+    AABB bounds; // Local bounds of the vertices and colliders
 
 private:
+    // What has been read of an OBJ file so far
+    struct ObjState
+    {
+        std::vector<float> vert_palette;
+        std::vector<float> uv_palette;
+        std::vector<Collider> colliders;
+        bool is3DTex = false;
+    };
+
+    // Reads one line of an OBJ file, Scanner reads its numbers, see ObjScanner
+    template <typename Scanner>
+    void ParseObjLine(const char* line, const char* end, ObjState& state);
+
     void AddFace(
         const std::vector<float>& vert_palette,
         const std::vector<float>& uv_palette,
@@ -38,12 +116,25 @@ private:
         uint32_t ct,
         bool is3DTex);
 
-    void SetupGL(bool is3DTex);
+    bool LoadBaked(const char* fname);
+    void SetupColliders(std::vector<Collider>& list);
+    void SetupIndices(MeshLayout layout, bool is3DTex);
+    void SetupFormat(bool is3DTex);
+    void ComputeBounds();
 
-    GLuint vao;
-    GLuint vbo[NUM_VBOS];
+    GLuint vao = 0;
+    GLuint vbo = 0; // Interleaved vertices, see VertexFormat
+    GLuint ebo = 0;
+    bool ready = false;
+    GLenum indexType = GL_UNSIGNED_INT; // 16 bit indices when every vertex can be addressed with them
+    bool instanceAttribs = false; // Whether the VAO reads the instance attribute yet
+    VertexFormat format;
+    // A loaded baked mesh stays mapped until Upload, which takes the packed vertices straight from it
+    std::unique_ptr<MappedFile> bakedFile;
+    const uint8_t* bakedVertices = nullptr;
 
     std::vector<float> verts;
     std::vector<float> uvs;
     std::vector<float> normals;
+    std::vector<uint32_t> indices;
 };
@@ -0,0 +1,40 @@
+#include "Mesh.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+/**
+ * Bakes every OBJ file in NonEuclidean/Meshes into the binary format
+ * Mesh loads without parsing, see Mesh::Bake. Run it from the repository
+ * root, the mesh_bake target does so after every change to a mesh.
+ */
+int main()
+{
+    std::error_code error;
+    int failures = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("NonEuclidean/Meshes", error))
+    {
+        if (entry.path().extension() != ".obj")
+        {
+            continue;
+        }
+        const std::string name = entry.path().filename().string();
+        const Mesh mesh(name.c_str(), ObjReader::MAPPED);
+        if (mesh.Bake(name.c_str()))
+        {
+            printf("%s -> %s\n", name.c_str(), Mesh::BakedPath(name.c_str()).c_str());
+        }
+        else
+        {
+            printf("%s: could not be baked\n", name.c_str());
+            failures += 1;
+        }
+    }
+    if (error)
+    {
+        printf("NonEuclidean/Meshes not found, run from the repository root\n");
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Vertex scoring of Forsyth's algorithm
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRI_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static const uint32_t NONE = UINT32_MAX;
+
+void WeldVertices(
+    std::vector<float>& verts,
+    std::vector<float>& uvs,
+    std::vector<float>& normals,
+    size_t uvSize,
+    std::vector<uint32_t>& indices)
+{
+    const size_t count = verts.size() / 3;
+    indices.resize(count);
+
+    // Open addressing table of the unique vertices, at most half full
+    size_t tableSize = 1;
+    while (tableSize < count * 2)
+    {
+        tableSize *= 2;
+    }
+    std::vector<uint32_t> table(tableSize, NONE);
+
+    // Unique vertices are moved to the front of the arrays, never past the one being read
+    size_t unique = 0;
+    auto same = [&](size_t a, size_t b) {
+        return memcmp(&verts[a * 3], &verts[b * 3], 3 * sizeof(float)) == 0
+               && memcmp(&uvs[a * uvSize], &uvs[b * uvSize], uvSize * sizeof(float)) == 0
+               && memcmp(&normals[a * 3], &normals[b * 3], 3 * sizeof(float)) == 0;
+    };
+    auto hash = [&](size_t v) {
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix = [&h](const float* data, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint32_t bits;
+                memcpy(&bits, &data[i], sizeof(bits));
+                h = (h ^ bits) * 0x100000001B3ull;
+            }
+        };
+        mix(&verts[v * 3], 3);
+        mix(&uvs[v * uvSize], uvSize);
+        mix(&normals[v * 3], 3);
+        return (size_t) (h ^ (h >> 32));
+    };
+    for (size_t v = 0; v < count; ++v)
+    {
+        size_t slot = hash(v) & (tableSize - 1);
+        while (table[slot] != NONE && !same(v, table[slot]))
+        {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == NONE)
+        {
+            std::copy(&verts[v * 3], &verts[v * 3] + 3, &verts[unique * 3]);
+            std::copy(&uvs[v * uvSize], &uvs[v * uvSize] + uvSize, &uvs[unique * uvSize]);
+            std::copy(&normals[v * 3], &normals[v * 3] + 3, &normals[unique * 3]);
+            table[slot] = (uint32_t) unique++;
+        }
+        indices[v] = table[slot];
+    }
+    verts.resize(unique * 3);
+    uvs.resize(unique * uvSize);
+    normals.resize(unique * 3);
+}
+
+// Score of a vertex at the given position in the cache, -1 if it is not in it, with the given number of
+// triangles left to draw
+static float VertexScore(int cachePosition, uint32_t remainingTris)
+{
+    if (remainingTris == 0)
+    {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // Used by the last triangle, a fixed score so it is not reused right away
+            score = LAST_TRI_SCORE;
+        }
+        else
+        {
+            const float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    return score + VALENCE_BOOST_SCALE * std::pow((float) remainingTris, -VALENCE_BOOST_POWER);
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t numVertices)
+{
+    const size_t numTris = indices.size() / 3;
+    if (numTris == 0)
+    {
+        return;
+    }
+
+    // Triangles of every vertex, the first 'remaining' of them are not drawn yet
+    std::vector<uint32_t> firstTri(numVertices + 1, 0);
+    std::vector<uint32_t> remaining(numVertices, 0);
+    for (uint32_t v : indices) { remaining[v] += 1; }
+    for (size_t v = 0; v < numVertices; ++v) { firstTri[v + 1] = firstTri[v] + remaining[v]; }
+    std::vector<uint32_t> vertexTris(indices.size());
+    std::vector<uint32_t> filled(numVertices, 0);
+    for (size_t t = 0; t < numTris; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[t * 3 + k];
+            vertexTris[firstTri[v] + filled[v]++] = (uint32_t) t;
+        }
+    }
+
+    std::vector<int> cachePosition(numVertices, -1);
+    std::vector<float> vertexScore(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) { vertexScore[v] = VertexScore(-1, remaining[v]); }
+    std::vector<float> triScore(numTris);
+    std::vector<bool> drawn(numTris, false);
+    uint32_t best = 0;
+    for (size_t t = 0; t < numTris; ++t)
+    {
+        triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        best = (triScore[t] > triScore[best]) ? (uint32_t) t : best;
+    }
+
+    // The cache holds three extra entries, for the vertices a triangle pushes out
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    newCache.reserve(VERTEX_CACHE_SIZE + 3);
+    std::vector<uint32_t> order;
+    order.reserve(indices.size());
+    size_t nextUndrawn = 0;
+    for (size_t n = 0; n < numTris; ++n)
+    {
+        if (best == NONE)
+        {
+            // Nothing in the cache has triangles left, continue with the next undrawn one
+            while (drawn[nextUndrawn])
+            {
+                nextUndrawn += 1;
+            }
+            best = (uint32_t) nextUndrawn;
+        }
+
+        // Draw the triangle and take it off its vertices' lists
+        drawn[best] = true;
+        newCache.clear();
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[best * 3 + k];
+            order.push_back(v);
+            newCache.push_back(v);
+            uint32_t* tris = &vertexTris[firstTri[v]];
+            std::swap(*std::find(tris, tris + remaining[v], best), tris[remaining[v] - 1]);
+            remaining[v] -= 1;
+        }
+        for (uint32_t v : cache)
+        {
+            if (std::find(newCache.begin(), newCache.begin() + 3, v) == newCache.begin() + 3)
+            {
+                newCache.push_back(v);
+            }
+        }
+
+        // Rescore the vertices in the cache and the ones that fell out of it
+        for (size_t i = 0; i < newCache.size(); ++i)
+        {
+            const uint32_t v = newCache[i];
+            cachePosition[v] = (i < (size_t) VERTEX_CACHE_SIZE) ? (int) i : -1;
+            vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+        }
+
+        // The next triangle is the best one using a cached vertex
+        best = NONE;
+        float bestScore = -1.0f;
+        for (uint32_t v : newCache)
+        {
+            for (uint32_t i = 0; i < remaining[v]; ++i)
+            {
+                const uint32_t t = vertexTris[firstTri[v] + i];
+                triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]]
+                              + vertexScore[indices[t * 3 + 2]];
+                if (triScore[t] > bestScore)
+                {
+                    bestScore = triScore[t];
+                    best = t;
+                }
+            }
+        }
+        newCache.resize(std::min(newCache.size(), (size_t) VERTEX_CACHE_SIZE));
+        cache.swap(newCache);
+    }
+    indices.swap(order);
+}
+
+void OptimizeVertexFetch(
+    std::vector<float>& verts,
+    std::vector<float>& uvs,
+    std::vector<float>& normals,
+    size_t uvSize,
+    std::vector<uint32_t>& indices)
+{
+    const size_t numVertices = verts.size() / 3;
+    std::vector<uint32_t> remap(numVertices, NONE);
+    std::vector<float> newVerts, newUvs, newNormals;
+    newVerts.reserve(verts.size());
+    newUvs.reserve(uvs.size());
+    newNormals.reserve(normals.size());
+    for (uint32_t& ix : indices)
+    {
+        if (remap[ix] == NONE)
+        {
+            remap[ix] = (uint32_t) (newVerts.size() / 3);
+            newVerts.insert(newVerts.end(), &verts[ix * 3], &verts[ix * 3] + 3);
+            newUvs.insert(newUvs.end(), &uvs[ix * uvSize], &uvs[ix * uvSize] + uvSize);
+            newNormals.insert(newNormals.end(), &normals[ix * 3], &normals[ix * 3] + 3);
+        }
+        ix = remap[ix];
+    }
+    verts.swap(newVerts);
+    uvs.swap(newUvs);
+    normals.swap(newNormals);
+}
+
+float AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t numVertices, int cacheSize)
+{
+    if (indices.empty())
+    {
+        return 0.0f;
+    }
+
+    // A vertex is in the FIFO if it was added within the last cacheSize misses
+    std::vector<int64_t> addedAt(numVertices, INT64_MIN / 2);
+    int64_t misses = 0;
+    for (uint32_t v : indices)
+    {
+        if (misses - addedAt[v] >= cacheSize)
+        {
+            addedAt[v] = misses;
+            misses += 1;
+        }
+    }
+    return (float) misses / (float) (indices.size() / 3);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Post-transform vertex cache size the triangle order is optimized for
+static const int VERTEX_CACHE_SIZE = 32;
+
+/**
+ * Merges vertices whose position, UV and normal are bitwise identical.
+ * Takes triangle soup, one vertex per corner, and leaves every vertex once
+ * in the arrays, in order of first use, with three indices per triangle.
+ */
+void WeldVertices(
+    std::vector<float>& verts,
+    std::vector<float>& uvs,
+    std::vector<float>& normals,
+    size_t uvSize,
+    std::vector<uint32_t>& indices);
+
+/**
+ * Reorders triangles so vertices are reused while they are still in the
+ * post-transform cache, after Tom Forsyth's linear-speed vertex cache
+ * optimisation.
+ */
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t numVertices);
+
+/**
+ * Renumbers vertices in the order the indices first use them, so vertex
+ * fetches walk the arrays front to back.
+ */
+void OptimizeVertexFetch(
+    std::vector<float>& verts,
+    std::vector<float>& uvs,
+    std::vector<float>& normals,
+    size_t uvSize,
+    std::vector<uint32_t>& indices);
+
+// Vertices transformed per triangle with a FIFO cache of the given size, 3 without any reuse
+float AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t numVertices, int cacheSize);
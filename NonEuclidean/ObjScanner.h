@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+/**
+ * Reads the numbers of one OBJ line in place, the same way a string stream
+ * reads them: whitespace is skipped, a failed read sets the value to 0 and
+ * every read after it leaves its value alone. Slashes can be read as
+ * whitespace, for the indices of faces.
+ */
+class ObjScanner
+{
+public:
+    ObjScanner(const char* begin, const char* end, bool slashesAreSpaces)
+        : p(begin)
+        , end(end)
+        , slashesAreSpaces(slashesAreSpaces)
+    {
+    }
+
+    ObjScanner& operator>>(float& value) { return Read(value); }
+    ObjScanner& operator>>(uint32_t& value) { return Read(value); }
+
+    bool Fail() const { return fail; }
+
+private:
+    template <typename T>
+    ObjScanner& Read(T& value)
+    {
+        if (fail)
+        {
+            return *this;
+        }
+        while (p < end && (std::isspace((unsigned char) *p) || (slashesAreSpaces && *p == '/')))
+        {
+            ++p;
+        }
+        if (p < end && *p == '+')
+        {
+            ++p;
+        }
+        const std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+        {
+            value = 0;
+            fail = true;
+            return *this;
+        }
+        p = result.ptr;
+        return *this;
+    }
+
+    const char* p;
+    const char* end;
+    bool slashesAreSpaces;
+    bool fail = false;
+};
+
+// Same interface over a string stream, which is how OBJ lines used to be read
+class ObjStreamScanner
+{
+public:
+    ObjStreamScanner(const char* begin, const char* end, bool slashesAreSpaces)
+    {
+        std::string line(begin, end);
+        if (slashesAreSpaces)
+        {
+            for (char& c : line)
+            {
+                c = (c == '/') ? ' ' : c;
+            }
+        }
+        ss.str(line);
+    }
+
+    template <typename T>
+    ObjStreamScanner& operator>>(T& value)
+    {
+        ss >> value;
+        return *this;
+    }
+
+    bool Fail() const { return ss.fail(); }
+
+private:
+    std::stringstream ss;
+};
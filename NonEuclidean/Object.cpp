@@ -1,13 +1,14 @@
 #include "Object.h"
 #include "Mesh.h"
-#include "Shader.h"
-#include "Texture.h"
+
+thread_local Object::TransformCounts Object::transformCounts;
 
 Object::Object()
     : pos(0.0f)
     , euler(0.0f)
     , scale(1.0f)
     , p_scale(1.0f)
+    , cacheValid(false)
 {
 }
 
@@ -19,22 +20,10 @@ void Object::Reset()
     p_scale = 1.0f;
 }
 
-void Object::Draw(const Camera& cam, uint32_t curFBO, int objId)
+void Object::Draw(const Camera& /*cam*/, uint32_t /*curFBO*/, int /*objId*/)
 {
-    if (shader && mesh)
-    {
-        const Matrix4 mv = WorldToLocal().Transposed();
-        const Matrix4 mvp = cam.Matrix() * LocalToWorld();
-        shader->Use();
-        if (texture)
-        {
-            texture->Use();
-        }
-        shader->SetMVP(mvp.m, mv.m);
-        shader->SetObjId(objId);
-        shader->SetColor(color);
-        mesh->Draw();
-    }
+    // Objects with a mesh and a shader are drawn by the engine's RenderQueue,
+    // their shaders read the transform from its per frame object data
 }
 
 Vector3 Object::Forward() const
@@ -44,14 +33,48 @@ Vector3 Object::Forward() const
 
 Matrix4 Object::LocalToWorld() const
 {
-    return Matrix4::Trans(pos) * Matrix4::RotY(euler.y) * Matrix4::RotX(euler.x) * Matrix4::RotZ(euler.z)
-           * Matrix4::Scale(scale * p_scale);
+    UpdateTransform();
+    return cachedLocalToWorld;
 }
 
 Matrix4 Object::WorldToLocal() const
 {
-    return Matrix4::Scale(1.0f / (scale * p_scale)) * Matrix4::RotZ(-euler.z) * Matrix4::RotX(-euler.x)
-           * Matrix4::RotY(-euler.y) * Matrix4::Trans(-pos);
+    UpdateTransform();
+    return cachedWorldToLocal;
+}
+
+void Object::UpdateTransform() const
+{
+    // The fields are public and written all over the place, so compare against
+    // the state the cache was built from instead of tracking every write
+    if (cacheValid && pos.x == cachedPos.x && pos.y == cachedPos.y && pos.z == cachedPos.z
+        && euler.x == cachedEuler.x && euler.y == cachedEuler.y && euler.z == cachedEuler.z
+        && scale.x == cachedScale.x && scale.y == cachedScale.y && scale.z == cachedScale.z
+        && p_scale == cachedPScale)
+    {
+        transformCounts.reused += 1;
+        return;
+    }
+
+    cachedLocalToWorld = Matrix4::Trans(pos) * Matrix4::RotY(euler.y) * Matrix4::RotX(euler.x)
+                         * Matrix4::RotZ(euler.z) * Matrix4::Scale(scale * p_scale);
+    cachedWorldToLocal = Matrix4::Scale(1.0f / (scale * p_scale)) * Matrix4::RotZ(-euler.z)
+                         * Matrix4::RotX(-euler.x) * Matrix4::RotY(-euler.y) * Matrix4::Trans(-pos);
+    cachedPos = pos;
+    cachedEuler = euler;
+    cachedScale = scale;
+    cachedPScale = p_scale;
+    cacheValid = true;
+    transformCounts.recomputed += 1;
+}
+
+AABB Object::WorldBounds() const
+{
+    if (!mesh)
+    {
+        return AABB();
+    }
+    return mesh->bounds.Transformed(LocalToWorld());
 }
 
 void Object::DebugDraw(const Camera& cam)
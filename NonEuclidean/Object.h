@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AABB.h"
 #include "Camera.h"
 #include "GameHeader.h"
 #include "Sphere.h"
@@ -20,6 +21,7 @@ struct Object
     virtual ~Object() {}
 
     virtual void Reset();
+    // Only for objects that draw themselves, the engine draws the ones with a mesh and a shader
     virtual void Draw(const Camera& cam, uint32_t curFBO, int objId);
     virtual void Update() {};
     virtual void OnHit(Object& other, Vector3& push) {};
@@ -30,9 +32,20 @@ struct Object
 
     void DebugDraw(const Camera& cam);
 
+    // Both are cached and only rebuilt after pos, euler, scale or p_scale change
     Matrix4 LocalToWorld() const;
     Matrix4 WorldToLocal() const;
     Vector3 Forward() const;
+    AABB WorldBounds() const;
+
+    // Number of transform lookups that rebuilt or reused the cached matrices
+    struct TransformCounts
+    {
+        int64_t recomputed = 0;
+        int64_t reused = 0;
+    };
+    // Counted per thread, so the physics threads do not contend on them, see Engine::Update
+    static thread_local TransformCounts transformCounts;
 
     Vector3 pos;
     Vector3 euler;
@@ -46,5 +59,17 @@ struct Object
     std::shared_ptr<Shader> shader;
 
     Vector3 color;
+
+private:
+    void UpdateTransform() const;
+
+    // Cached matrices and the state they were built from
+    mutable Matrix4 cachedLocalToWorld;
+    mutable Matrix4 cachedWorldToLocal;
+    mutable Vector3 cachedPos;
+    mutable Vector3 cachedEuler;
+    mutable Vector3 cachedScale;
+    mutable float cachedPScale;
+    mutable bool cacheValid;
 };
 typedef std::vector<std::shared_ptr<Object>> PObjectVec;
@@ -15,6 +15,8 @@ void Physical::Reset()
     friction = 0.0f;
     high_friction = 0.0f;
     drag = 0.0f;
+    retainedDrag = 0.0f;
+    dragRetain = 1.0f;
     prev_pos.SetZero();
 }
 
@@ -22,7 +24,12 @@ void Physical::Update()
 {
     prev_pos = pos;
     velocity += gravity * p_scale * GH_DT;
-    velocity *= (1.0f - drag);
+    if (drag != retainedDrag)
+    {
+        retainedDrag = drag;
+        dragRetain = GH_STEP_RETAIN(drag);
+    }
+    velocity *= dragRetain;
     pos += velocity * GH_DT;
 }
 
@@ -47,7 +54,7 @@ void Physical::OnCollide(Object& other, const Vector3& push)
 
     // Update velocity to react to collision
     const Vector3 push_proj = push * (velocity.Dot(push) / push.Dot(push));
-    velocity = (velocity - push_proj) * (1.0f - kinetic_friction) - push_proj * bounce;
+    velocity = (velocity - push_proj) * GH_STEP_RETAIN(kinetic_friction) - push_proj * bounce;
 }
 
 bool Physical::TryPortal(const Portal& portal)
@@ -72,3 +79,14 @@ bool Physical::TryPortal(const Portal& portal)
     }
     return false;
 }
+
+AABB Physical::HitBounds() const
+{
+    const Matrix4 localToWorld = LocalToWorld();
+    AABB bounds;
+    for (size_t i = 0; i < hitSpheres.size(); ++i)
+    {
+        bounds.Extend(AABB::OfUnitSphere(localToWorld * hitSpheres[i].UnitToLocal()));
+    }
+    return bounds;
+}
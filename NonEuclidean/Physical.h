@@ -21,6 +21,8 @@ public:
 
     virtual bool TryPortal(const Portal& portal);
 
+    AABB HitBounds() const;
+
     virtual Physical* AsPhysical() override { return this; }
 
     Vector3 gravity;
@@ -33,4 +35,9 @@ public:
     Vector3 prev_pos;
 
     std::vector<Sphere> hitSpheres;
+
+private:
+    // GH_STEP_RETAIN of the drag, only recomputed when the drag changes
+    float retainedDrag;
+    float dragRetain;
 };
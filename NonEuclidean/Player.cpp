@@ -32,7 +32,7 @@ void Player::Update()
     {
         magT = 0.0f;
     }
-    bob_mag = bob_mag * (1.0f - GH_BOB_DAMP) + magT * GH_BOB_DAMP;
+    bob_mag = bob_mag * GH_BOB_RETAIN + magT * (1.0f - GH_BOB_RETAIN);
     if (bob_mag < GH_BOB_MIN)
     {
         bob_phi = 0.0f;
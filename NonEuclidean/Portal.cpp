@@ -12,6 +12,11 @@ Portal::Portal()
     errShader = AquireShader("pink");
 }
 
+bool Portal::IsReady() const
+{
+    return mesh->IsReady() && shader->IsReady() && errShader->IsReady();
+}
+
 void Portal::Draw(const Camera& cam, GLuint curFBO, int objId)
 {
     assert(euler.x == 0.0f);
@@ -24,11 +29,30 @@ void Portal::Draw(const Camera& cam, GLuint curFBO, int objId)
         return;
     }
 
+    Camera portalCam;
+    const Warp* warp;
+    if (!View(cam, portalCam, warp))
+    {
+        return;
+    }
+
+    if (GH_ENGINE->args.portalMode == PortalMode::STENCIL)
+    {
+        DrawStencil(cam, portalCam, *warp, curFBO);
+    }
+    else
+    {
+        DrawTexture(cam, portalCam, *warp, curFBO, objId);
+    }
+}
+
+bool Portal::View(const Camera& cam, Camera& portalCam, const Warp*& warp) const
+{
     // Find normal relative to camera
     Vector3 normal = Forward();
     const Vector3 camPos = cam.worldView.Inverse().Translation();
     const bool frontDirection = (camPos - pos).Dot(normal) > 0;
-    const Warp* warp = (frontDirection ? &front : &back);
+    warp = (frontDirection ? &front : &back);
     if (frontDirection)
     {
         normal = -normal;
@@ -38,24 +62,110 @@ void Portal::Draw(const Camera& cam, GLuint curFBO, int objId)
     const float extra_clip = GH_MIN(GH_ENGINE->NearestPortalDist() * 0.5f, 0.1f);
 
     // Create new portal camera
-    Camera portalCam = cam;
+    portalCam = cam;
     portalCam.ClipOblique(pos - normal * extra_clip, -normal);
     portalCam.worldView *= warp->delta;
-    portalCam.width = GH_FBO_SIZE;
-    portalCam.height = GH_FBO_SIZE;
 
-    // Render portal's view from new camera
-    frameBuf[GH_REC_LEVEL - 1].Render(portalCam, curFBO, warp->toPortal);
+    // The view only needs to be drawn where the portal covers the screen,
+    // which is never more than the part of the screen this view covers
+    const Matrix4 localToWorld = LocalToWorld();
+    const Vector3 corners[4] = {
+        localToWorld.MulPoint(Vector3(-1, -1, 0)), localToWorld.MulPoint(Vector3(1, -1, 0)),
+        localToWorld.MulPoint(Vector3(1, 1, 0)), localToWorld.MulPoint(Vector3(-1, 1, 0))};
+    portalCam.visible = cam.Project(corners, 4);
+    return !portalCam.visible.IsEmpty();
+}
+
+// Power of two size of a target that holds 'pixels' of the view a portal is seen in
+static int TargetSize(float pixels)
+{
+    int size = GH_FBO_MIN_SIZE;
+    while (size < pixels && size < GH_FBO_SIZE)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+void Portal::DrawTexture(const Camera& cam, const Camera& portalCam, const Warp& warp, GLuint curFBO, int objId)
+{
+    // Only the part of the view the portal covers is rendered, into the
+    // corner of the target, at about the resolution it has in the view it is
+    // seen in. Views seen through several portals get a bit less.
+    const Camera::Rect& rect = portalCam.visible;
+    const float scale = (GH_REC_LEVEL < GH_MAX_RECURSION - 1) ? GH_FBO_LEVEL_SCALE : 1.0f;
+    Camera targetCam = portalCam;
+    targetCam.Crop(rect);
+    targetCam.width = TargetSize((rect.x1 - rect.x0) * 0.5f * cam.width * scale);
+    targetCam.height = TargetSize((rect.y1 - rect.y0) * 0.5f * cam.height * scale);
+
+    // Render portal's view from new camera, into the engine's target for this
+    // level. Deeper portals use the lower levels, so it stays intact until
+    // the portal has been drawn.
+    FrameBuffer& frameBuf = GH_ENGINE->PortalTarget(GH_REC_LEVEL - 1);
+    frameBuf.Render(targetCam, curFBO, warp.toPortal);
     cam.UseViewport();
 
     // Now we can render the portal texture to the screen
     const Matrix4 mv = LocalToWorld();
     const Matrix4 mvp = cam.Matrix() * mv;
     shader->Use();
-    frameBuf[GH_REC_LEVEL - 1].Use();
+    frameBuf.Use();
     shader->SetMVP(mvp.m, mv.m);
     shader->SetObjId(objId);
+
+    // Map the portal's position in this view to the corner the view through it was rendered to
+    const float scaleX = targetCam.width / (float) GH_FBO_SIZE / (rect.x1 - rect.x0);
+    const float scaleY = targetCam.height / (float) GH_FBO_SIZE / (rect.y1 - rect.y0);
+    shader->SetUVTransform(scaleX, scaleY, -rect.x0 * scaleX, -rect.y0 * scaleY);
+    mesh->Draw();
+}
+
+void Portal::DrawStencil(const Camera& cam, const Camera& portalCam, const Warp& warp, GLuint curFBO)
+{
+    // Stencil value of the view this portal is seen in, the view through it gets one more
+    const int ref = GH_MAX_RECURSION - GH_REC_LEVEL - 1;
+    const Matrix4 mv = LocalToWorld();
+    const Matrix4 mvp = cam.Matrix() * mv;
+    errShader->Use();
+    errShader->SetMVP(mvp.m, mv.m);
+
+    // Mark the visible pixels of the portal
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glStencilFunc(GL_EQUAL, ref, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    mesh->Draw();
+
+    // Push their depth back to the far plane, so the view can be drawn there
+    glStencilFunc(GL_EQUAL, ref + 1, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_ALWAYS);
+    glDepthRange(1.0, 1.0);
+    mesh->Draw();
+    glDepthRange(0.0, 1.0);
+    glDepthFunc(GL_LESS);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Render portal's view in place, Render only touches the marked pixels
+    portalCam.UseViewport();
+    GH_ENGINE->Render(portalCam, curFBO, warp.toPortal);
+    cam.UseViewport();
+
+    // Restore the portal's depth and unmark its pixels, so the rest of this
+    // view is tested against the portal like any other surface
+    errShader->Use();
+    errShader->SetMVP(mvp.m, mv.m);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilFunc(GL_EQUAL, ref + 1, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+    glDepthFunc(GL_ALWAYS);
     mesh->Draw();
+    glDepthFunc(GL_LESS);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glStencilFunc(GL_EQUAL, ref, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 }
 
 void Portal::DrawPink(const Camera& cam)
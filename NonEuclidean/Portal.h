@@ -7,6 +7,13 @@
 #include "Shader.h"
 #include <memory>
 
+// How the view through a portal gets on screen
+enum class PortalMode
+{
+    TEXTURE, // Rendered into an offscreen target, then sampled by the portal's quad
+    STENCIL, // Rendered in place, limited to the portal's pixels by the stencil buffer
+};
+
 class Portal : public Object
 {
 public:
@@ -33,6 +40,16 @@ public:
     virtual void Draw(const Camera& cam, GLuint curFBO, int objId) override;
     void DrawPink(const Camera& cam);
 
+    // Whether its mesh and shaders have loaded, portals that are not ready are neither drawn nor looked through
+    bool IsReady() const;
+
+    /**
+     * Camera for the view through the portal from cam, with the warp it
+     * crosses. Returns false if the portal covers none of cam's visible
+     * rectangle.
+     */
+    bool View(const Camera& cam, Camera& portalCam, const Warp*& warp) const;
+
     Vector3 GetBump(const Vector3& a) const;
     const Warp* Intersects(const Vector3& a, const Vector3& b, const Vector3& bump) const;
     float DistTo(const Vector3& pt) const;
@@ -44,7 +61,9 @@ public:
     Warp back;
 
 private:
+    void DrawTexture(const Camera& cam, const Camera& portalCam, const Warp& warp, GLuint curFBO, int objId);
+    void DrawStencil(const Camera& cam, const Camera& portalCam, const Warp& warp, GLuint curFBO);
+
     std::shared_ptr<Shader> errShader;
-    FrameBuffer frameBuf[GH_MAX_RECURSION <= 1 ? 1 : GH_MAX_RECURSION - 1];
 };
 typedef std::vector<std::shared_ptr<Portal>> PPortalVec;
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "PortalIndex.h"
+
+void PortalIndex::Sync(const PPortalVec& portals)
+{
+    // Expired entries never compare equal, so a new portal at a reused address still rebuilds
+    bool changed = (portals.size() != entries.size());
+    for (size_t i = 0; i < portals.size() && !changed; ++i) { changed = (entries[i].portal.lock() != portals[i]); }
+    if (!changed)
+    {
+        return;
+    }
+
+    entries.clear();
+    grid.Clear();
+    for (size_t i = 0; i < portals.size(); ++i)
+    {
+        const Portal& portal = *portals[i];
+        entries.push_back({portals[i], portal.pos, portal.Forward()});
+        const AABB quad(Vector3(-1.0f, -1.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f));
+        grid.Insert((int) i, quad.Transformed(portal.LocalToWorld()).Expanded(BOUNDS_EPSILON));
+    }
+}
+
+void PortalIndex::Query(const Vector3& a, const Vector3& b, float bump, std::vector<int>& result) const
+{
+    AABB segment;
+    segment.Extend(a);
+    segment.Extend(b);
+    grid.Query(segment.Expanded(bump), result);
+
+    // Same plane test Portal::Intersects starts with, for both bump directions
+    size_t kept = 0;
+    for (int i : result)
+    {
+        const Entry& entry = entries[i];
+        const Vector3 n = entry.normal;
+        const Vector3 p = entry.pos + n * ((a - entry.pos).Dot(n) > 0 ? bump : -bump);
+        if (n.Dot(a - p) * n.Dot(b - p) <= 0.0f)
+        {
+            result[kept++] = i;
+        }
+    }
+    result.resize(kept);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "BroadPhase.h"
+#include "Portal.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Portals in a uniform grid, with the plane data Portal::Intersects starts
+ * with, so a movement segment is only tested against the portals it could
+ * cross. Portals are expected to stay where they are once added.
+ */
+class PortalIndex
+{
+public:
+    // Rebuilds the index if portals were added or removed since the last call
+    void Sync(const PPortalVec& portals);
+
+    /**
+     * Collects the indices of the portals whose plane, bumped by up to
+     * 'bump', the segment from a to b crosses inside their bounds. Indices
+     * are sorted, a portal that is left out cannot be crossed.
+     */
+    void Query(const Vector3& a, const Vector3& b, float bump, std::vector<int>& result) const;
+
+    size_t Size() const { return entries.size(); }
+
+private:
+    // Portal bounds are grown by this to absorb rounding in the crossing test
+    static constexpr float BOUNDS_EPSILON = 1e-3f;
+
+    struct Entry
+    {
+        std::weak_ptr<Portal> portal;
+        Vector3 pos;
+        Vector3 normal;
+    };
+
+    std::vector<Entry> entries;
+    BroadPhase grid;
+};
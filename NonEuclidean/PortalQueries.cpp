@@ -0,0 +1,86 @@
+#include "PortalQueries.h"
+
+PortalQueries::~PortalQueries()
+{
+    Clear();
+}
+
+bool PortalQueries::Test(const std::shared_ptr<Portal>& portal, uint64_t view, const Camera& cam)
+{
+    if (!portal->IsReady())
+    {
+        // Nothing to draw the query with yet, see AssetLoader
+        return false;
+    }
+
+    // Same view, seen through the same chain of portals, in an earlier frame
+    const uint64_t key = (view ^ (uint64_t) (uintptr_t) portal.get()) * 0x9E3779B97F4A7C15ull;
+    Entry& entry = entries[key];
+    if (entry.portal.lock() != portal)
+    {
+        // New view, or the portal that used the entry is gone
+        entry.portal = portal;
+        entry.known = false;
+    }
+    if (entry.query == 0)
+    {
+        glGenQueries(1, &entry.query);
+    }
+
+    // Pick up the result of the last query if the GPU is done with it
+    if (entry.pending)
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT, &samples);
+            entry.visible = (samples > 0);
+            entry.known = true;
+            entry.pending = false;
+        }
+    }
+
+    // A result from before the view was last out of sight says nothing about now
+    const bool recent = entry.known && entry.lastUsed >= frame - 1;
+    const bool visible = !recent || entry.visible;
+    entry.lastUsed = frame;
+    stats.stallsAvoided += 1;
+    stats.culled += (visible ? 0 : 1);
+    stats.unknown += (recent ? 0 : 1);
+
+    if (!entry.pending)
+    {
+        glBeginQuery(GL_SAMPLES_PASSED, entry.query);
+        portal->DrawPink(cam);
+        glEndQuery(GL_SAMPLES_PASSED);
+        entry.pending = true;
+    }
+    return visible;
+}
+
+void PortalQueries::EndFrame()
+{
+    frame += 1;
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.lastUsed < frame - MAX_IDLE_FRAMES)
+        {
+            glDeleteQueries(1, &it->second.query);
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void PortalQueries::Clear()
+{
+#ifndef GH_HEADLESS
+    for (auto& entry : entries) { glDeleteQueries(1, &entry.second.query); }
+#endif
+    entries.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Camera.h"
+#include "Portal.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Occlusion queries for portals that live across frames. A portal's
+ * visibility is decided from the result of the query issued for the same
+ * view in an earlier frame, so the CPU never waits for the GPU. Portals
+ * without a recent result are drawn.
+ */
+class PortalQueries
+{
+public:
+    // Counters accumulated between two stats reports
+    struct Stats
+    {
+        int64_t stallsAvoided = 0; // Decisions that used to wait for a query result
+        int64_t culled = 0;        // Portals skipped because they were hidden
+        int64_t unknown = 0;       // Portals drawn because no result had arrived
+    };
+
+    ~PortalQueries();
+
+    /**
+     * Decides whether the portal is visible in the view identified by
+     * 'view', then draws the portal's proxy into a new query for that view
+     * unless one is still in flight. Color and depth writes must be off.
+     */
+    bool Test(const std::shared_ptr<Portal>& portal, uint64_t view, const Camera& cam);
+
+    // Frees the queries of views that were not rendered for a while
+    void EndFrame();
+    void Clear();
+
+    Stats stats;
+
+private:
+    // Queries unused for this many frames are freed
+    static const int64_t MAX_IDLE_FRAMES = 60;
+
+    struct Entry
+    {
+        std::weak_ptr<Portal> portal;
+        GLuint query = 0;
+        bool pending = false;
+        bool known = false;
+        bool visible = true;
+        int64_t lastUsed = -1;
+    };
+
+    std::unordered_map<uint64_t, Entry> entries;
+    int64_t frame = 0;
+};
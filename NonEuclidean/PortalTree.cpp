@@ -0,0 +1,116 @@
+#include "PortalTree.h"
+#include "Frustum.h"
+
+#include <algorithm>
+
+static float Area(const Camera::Rect& rect)
+{
+    return (rect.x1 - rect.x0) * (rect.y1 - rect.y0) * 0.25f;
+}
+
+void PortalTree::Build(
+    const Camera& cam,
+    const Portal* skipPortal,
+    const PPortalVec& portals,
+    int maxDepth,
+    int passBudget,
+    float pixelBudget)
+{
+    nodes.clear();
+    candidates.clear();
+
+    // The view itself is always rendered
+    Node root;
+    root.skipPortal = skipPortal;
+    root.area = Area(cam.visible);
+    root.rendered = true;
+    root.cam = cam;
+    nodes.push_back(root);
+
+    // Spend the budget on the largest views. A view can only be rendered
+    // inside the one it is seen in, so its children become candidates once
+    // it has been picked.
+    auto smaller = [this](int a, int b) { return nodes[a].area < nodes[b].area; };
+    auto expand = [&](int ix) {
+        const size_t first = nodes.size();
+        Expand(ix, portals, maxDepth);
+        for (size_t i = first; i < nodes.size(); ++i)
+        {
+            candidates.push_back((int) i);
+            std::push_heap(candidates.begin(), candidates.end(), smaller);
+        }
+    };
+    expand(0);
+    int passes = 0;
+    float pixels = 0.0f;
+    while (!candidates.empty())
+    {
+        std::pop_heap(candidates.begin(), candidates.end(), smaller);
+        const int ix = candidates.back();
+        candidates.pop_back();
+        if (passes >= passBudget)
+        {
+            stats.overBudget += 1 + (int64_t) candidates.size();
+            break;
+        }
+        if (pixels + nodes[ix].area > pixelBudget)
+        {
+            // Smaller views may still fit
+            stats.overBudget += 1;
+            continue;
+        }
+        nodes[ix].rendered = true;
+        passes += 1;
+        pixels += nodes[ix].area;
+        expand(ix);
+    }
+    stats.views += (int64_t) nodes.size() - 1;
+    stats.rendered += passes;
+}
+
+int PortalTree::Child(int node, const Portal* portal) const
+{
+    for (int ix = nodes[node].firstChild; ix >= 0; ix = nodes[ix].nextSibling)
+    {
+        if (nodes[ix].portal == portal)
+        {
+            return ix;
+        }
+    }
+    return -1;
+}
+
+void PortalTree::Expand(int node, const PPortalVec& portals, int maxDepth)
+{
+    if (nodes[node].depth >= maxDepth)
+    {
+        return;
+    }
+
+    // Same tests Engine::Render and Portal::Draw use to skip a portal
+    const Frustum frustum(nodes[node].cam);
+    for (const std::shared_ptr<Portal>& portal : portals)
+    {
+        if (portal.get() == nodes[node].skipPortal || !portal->IsReady()
+            || !frustum.Overlaps(portal->WorldBounds()))
+        {
+            continue;
+        }
+        Node child;
+        const Portal::Warp* warp;
+        if (!portal->View(nodes[node].cam, child.cam, warp))
+        {
+            continue;
+        }
+        child.portal = portal.get();
+        child.skipPortal = warp->toPortal;
+        child.parent = node;
+        child.nextSibling = nodes[node].firstChild;
+        child.depth = nodes[node].depth + 1;
+        child.area = Area(child.cam.visible);
+
+        const int ix = (int) nodes.size();
+        nodes[node].firstChild = ix;
+        nodes.push_back(child);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Camera.h"
+#include "Portal.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Views seen through portals, built before a frame is rendered. Every node
+ * holds the camera of its view, with the warps of all portals on the way,
+ * and the part of the screen it covers. The largest views are rendered
+ * first until the pass or pixel budget runs out, the views that do not fit
+ * end the chain like the deepest ones do.
+ */
+class PortalTree
+{
+public:
+    // Counters accumulated between two stats reports
+    struct Stats
+    {
+        int64_t views = 0;      // Views through portals that were found
+        int64_t rendered = 0;   // Views that fit in the budget
+        int64_t overBudget = 0; // Views that did not
+    };
+
+    struct Node
+    {
+        const Portal* portal = nullptr;     // Portal the view is seen through, null for the root
+        const Portal* skipPortal = nullptr; // Portal the view looks out of
+        int parent = -1;
+        int firstChild = -1;
+        int nextSibling = -1;
+        int depth = 0;     // Number of portals the view is seen through
+        float area = 0.0f; // Fraction of the screen the view covers
+        bool rendered = false;
+        Camera cam;
+    };
+
+    /**
+     * Builds the tree of views seen from cam, at most maxDepth portals deep,
+     * and picks the ones to render. passBudget limits the number of views
+     * through portals, pixelBudget the screen area they cover together, in
+     * screens.
+     */
+    void Build(
+        const Camera& cam,
+        const Portal* skipPortal,
+        const PPortalVec& portals,
+        int maxDepth,
+        int passBudget,
+        float pixelBudget);
+
+    // View through the portal seen in the given view, or -1 if the portal covers none of it
+    int Child(int node, const Portal* portal) const;
+
+    const Node& Get(int node) const { return nodes[node]; }
+    size_t Size() const { return nodes.size(); }
+
+    Stats stats;
+
+private:
+    // Adds the views through the portals seen in the given view
+    void Expand(int node, const PPortalVec& portals, int maxDepth);
+
+    std::vector<Node> nodes;
+    std::vector<int> candidates; // Heap of views that may still be rendered, largest on top
+};
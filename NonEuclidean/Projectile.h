@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Physical.h"
+
+// Small sphere flying in a straight line, nothing collides with it in turn
+class Projectile : public Physical
+{
+public:
+    Projectile(const Vector3& start, const Vector3& _velocity, float radius)
+    {
+        SetPosition(start);
+        velocity = _velocity;
+        gravity.SetZero();
+        bounce = 0.5f;
+        hitSpheres.push_back(Sphere(Vector3(0, 0, 0), radius));
+    }
+    virtual ~Projectile() {}
+};
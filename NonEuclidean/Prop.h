@@ -0,0 +1,62 @@
+#pragma once
+
+#include "GameHeader.h"
+#include "Physical.h"
+#include "Resources.h"
+
+#include <random>
+
+// Small physical that wanders between random points around its home
+class Prop : public Physical
+{
+public:
+    Prop(const Vector3& home, float range, unsigned seed)
+        : home(home)
+        , range(range)
+        , rng(seed)
+    {
+        mesh = AquireMesh("pillar.obj");
+        shader = AquireShader("color");
+        color = Vector3(0.8f, 0.8f, 0.8f);
+        scale = Vector3(0.05f);
+        hitSpheres.push_back(Sphere(Vector3(0, 3, 0), 3));
+        friction = 0.04f;
+        drag = 0.002f;
+        PickTarget();
+        pos = target;
+    }
+    virtual ~Prop() {}
+
+    virtual void Update() override
+    {
+        Physical::Update();
+
+        // Head for the target, pick a new one once it is reached
+        Vector3 delta = target - pos;
+        delta.y = 0.0f;
+        if (delta.MagSq() < 0.01f || std::uniform_int_distribution<int>(0, 999)(rng) == 0)
+        {
+            PickTarget();
+        }
+        else
+        {
+            velocity += delta.Normalized() * (GH_WALK_ACCEL * 0.5f * GH_DT);
+            const float tempY = velocity.y;
+            velocity.y = 0.0f;
+            velocity.ClipMag(GH_WALK_SPEED * 0.5f);
+            velocity.y = tempY;
+        }
+    }
+
+private:
+    void PickTarget()
+    {
+        std::uniform_real_distribution<float> offset(-range, range);
+        target = home + Vector3(offset(rng), 0.0f, offset(rng));
+    }
+
+    Vector3 home;
+    Vector3 target;
+    float range;
+    std::mt19937 rng;
+};
@@ -0,0 +1,146 @@
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include <algorithm>
+
+// Binding points the texture and color shaders declare their blocks at
+static const GLuint OBJECTS_BINDING = 0;
+static const GLuint CAMERA_BINDING = 0;
+
+RenderQueue::~RenderQueue()
+{
+    Clear();
+}
+
+void RenderQueue::BeginFrame(const PObjectVec& objects)
+{
+    // Matrices are stored transposed, GLSL reads them column by column
+    objectData.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const Object& obj = *objects[i];
+        ObjectData& data = objectData[i];
+        const Matrix4 model = obj.LocalToWorld().Transposed();
+        const Matrix4 normal = obj.WorldToLocal();
+        std::copy(model.m, model.m + 16, data.model);
+        std::copy(normal.m, normal.m + 16, data.normal);
+        data.color[0] = obj.color.x;
+        data.color[1] = obj.color.y;
+        data.color[2] = obj.color.z;
+        data.color[3] = 1.0f;
+    }
+    const size_t bytes = objectData.size() * sizeof(ObjectData);
+    Upload(GL_SHADER_STORAGE_BUFFER, objectBuffer, objectCapacity, objectData.data(), bytes);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, objectBuffer);
+    stats.uploadedBytes += (int64_t) bytes;
+}
+
+void RenderQueue::Add(const Object& obj, int index)
+{
+    packets.push_back({obj.shader.get(), obj.texture.get(), obj.mesh.get(), index});
+}
+
+void RenderQueue::Submit(const Camera& cam, bool pickable)
+{
+    // Objects without a texture keep whatever is bound, so they do not count as a switch
+    Packet last = {nullptr, nullptr, nullptr, 0};
+    for (const Packet& p : packets)
+    {
+        stats.unsortedSwitches += (p.shader != last.shader) + (p.texture && p.texture != last.texture)
+                                  + (p.mesh != last.mesh);
+        last = {p.shader, p.texture ? p.texture : last.texture, p.mesh, p.index};
+    }
+
+    // Ties keep their order, so the result does not depend on the sort
+    std::stable_sort(packets.begin(), packets.end(), [](const Packet& a, const Packet& b) {
+        if (a.shader != b.shader)
+        {
+            return std::less<Shader*>()(a.shader, b.shader);
+        }
+        if (a.texture != b.texture)
+        {
+            return std::less<Texture*>()(a.texture, b.texture);
+        }
+        return std::less<Mesh*>()(a.mesh, b.mesh);
+    });
+
+    // Camera of the pass, and the objects to draw in sorted order
+    CameraData camera = {};
+    const Matrix4 viewProj = cam.Matrix().Transposed();
+    std::copy(viewProj.m, viewProj.m + 16, camera.viewProj);
+    camera.pickable = pickable ? 1 : 0;
+    Upload(GL_UNIFORM_BUFFER, cameraBuffer, cameraCapacity, &camera, sizeof(camera));
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, cameraBuffer);
+
+    instances.resize(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) { instances[i] = packets[i].index; }
+    const size_t instanceBytes = instances.size() * sizeof(Mesh::Instance);
+    Upload(GL_ARRAY_BUFFER, instanceBuffer, instanceCapacity, instances.data(), instanceBytes);
+    stats.uploadedBytes += (int64_t) (sizeof(camera) + instanceBytes);
+
+    // Other draws in between passes bind their own state, so start from nothing
+    last = {nullptr, nullptr, nullptr, 0};
+    size_t first = 0;
+    while (first < packets.size())
+    {
+        const Packet& p = packets[first];
+        size_t end = first + 1;
+        while (end < packets.size() && packets[end].shader == p.shader && packets[end].texture == p.texture
+               && packets[end].mesh == p.mesh)
+        {
+            end += 1;
+        }
+
+        if (p.shader != last.shader)
+        {
+            p.shader->Use();
+            last.shader = p.shader;
+            stats.programSwitches += 1;
+        }
+        if (p.texture && p.texture != last.texture)
+        {
+            p.texture->Use();
+            last.texture = p.texture;
+            stats.textureSwitches += 1;
+        }
+        if (p.mesh != last.mesh)
+        {
+            p.mesh->BindInstanced(instanceBuffer);
+            last.mesh = p.mesh;
+            stats.vaoSwitches += 1;
+        }
+        p.mesh->DrawInstanced((GLsizei) (end - first), (GLuint) first);
+        stats.draws += (int64_t) (end - first);
+        stats.batches += 1;
+        first = end;
+    }
+    packets.clear();
+}
+
+void RenderQueue::Clear()
+{
+    for (GLuint* buffer : {&objectBuffer, &cameraBuffer, &instanceBuffer})
+    {
+        if (*buffer != 0)
+        {
+            glDeleteBuffers(1, buffer);
+            *buffer = 0;
+        }
+    }
+    objectCapacity = cameraCapacity = instanceCapacity = 0;
+}
+
+void RenderQueue::Upload(GLenum target, GLuint& buffer, size_t& capacity, const void* data, size_t bytes)
+{
+    if (buffer == 0)
+    {
+        glGenBuffers(1, &buffer);
+    }
+
+    // Earlier passes may still be reading the buffer, orphaning it gives this upload new storage
+    capacity = GH_MAX(bytes, capacity);
+    glBindBuffer(target, buffer);
+    glBufferData(target, (GLsizeiptr) capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, (GLsizeiptr) bytes, data);
+}
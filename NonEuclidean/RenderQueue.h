@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Camera.h"
+#include "Mesh.h"
+#include "Object.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Objects to draw in one pass, sorted by shader, texture and mesh before
+ * they are submitted so each of them is only bound when it changes.
+ * Objects that share all three are drawn as instances of one draw call.
+ *
+ * Transforms and colors of all objects are uploaded once per frame into a
+ * shader storage buffer, the camera once per pass into a uniform buffer.
+ * Instances only carry the index of their object.
+ */
+class RenderQueue
+{
+public:
+    // Counters accumulated between two stats reports
+    struct Stats
+    {
+        int64_t draws = 0;   // Objects drawn
+        int64_t batches = 0; // Draw calls they took
+        int64_t programSwitches = 0;
+        int64_t textureSwitches = 0;
+        int64_t vaoSwitches = 0;
+        int64_t unsortedSwitches = 0; // Program, texture and VAO switches the same draws would need unsorted
+        int64_t uploadedBytes = 0;    // Object, camera and instance data sent to the GPU
+    };
+
+    ~RenderQueue();
+
+    // Uploads the data of every object, Add refers to them by their index in the list
+    void BeginFrame(const PObjectVec& objects);
+
+    // The object needs a shader and a mesh
+    void Add(const Object& obj, int index);
+
+    // Draws and removes everything that was added. Picking reports the
+    // index of the object, or -1 for passes that are not pickable.
+    void Submit(const Camera& cam, bool pickable);
+
+    // Frees the buffers
+    void Clear();
+
+    Stats stats;
+
+private:
+    // Shader storage block 'Objects' of the texture and color shaders, std430
+    struct ObjectData
+    {
+        float model[16];  // Column major
+        float normal[16]; // Column major
+        float color[4];
+    };
+
+    // Uniform block 'Camera' of the texture and color shaders, std140
+    struct CameraData
+    {
+        float viewProj[16]; // Column major
+        int32_t pickable;
+        int32_t padding[3];
+    };
+
+    struct Packet
+    {
+        Shader* shader;
+        Texture* texture;
+        Mesh* mesh;
+        int index;
+    };
+
+    static void Upload(GLenum target, GLuint& buffer, size_t& capacity, const void* data, size_t bytes);
+
+    std::vector<Packet> packets;
+    std::vector<ObjectData> objectData;
+    std::vector<Mesh::Instance> instances;
+    GLuint objectBuffer = 0;
+    GLuint cameraBuffer = 0;
+    GLuint instanceBuffer = 0;
+    size_t objectCapacity = 0;
+    size_t cameraCapacity = 0;
+    size_t instanceCapacity = 0;
+};
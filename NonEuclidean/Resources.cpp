@@ -1,13 +1,34 @@
 #include "Resources.h"
+#include "AssetLoader.h"
+#include "GameHeader.h"
+#include <string>
 #include <unordered_map>
 
+// Loads the asset on the loader's threads when there is one, right away otherwise. The
+// name is copied, the caller's string may be gone by the time a worker gets to it.
+template <typename T, typename... LoadArgs>
+static std::shared_ptr<T> Start(const std::string& name, LoadArgs... args)
+{
+    auto asset = std::make_shared<T>();
+    if (GH_ASSETS)
+    {
+        GH_ASSETS->Load([asset, name, args...] { asset->Load(name.c_str(), args...); }, [asset] { asset->Upload(); });
+    }
+    else
+    {
+        asset->Load(name.c_str(), args...);
+        asset->Upload();
+    }
+    return asset;
+}
+
 std::shared_ptr<Mesh> AquireMesh(const char* name)
 {
     static std::unordered_map<std::string, std::weak_ptr<Mesh>> map;
     std::weak_ptr<Mesh>& mesh = map[std::string(name)];
     if (mesh.expired())
     {
-        std::shared_ptr<Mesh> newMesh(new Mesh(name));
+        std::shared_ptr<Mesh> newMesh = Start<Mesh>(name);
         mesh = newMesh;
         return newMesh;
     }
@@ -23,7 +44,7 @@ std::shared_ptr<Shader> AquireShader(const char* name)
     std::weak_ptr<Shader>& shader = map[std::string(name)];
     if (shader.expired())
     {
-        std::shared_ptr<Shader> newShader(new Shader(name));
+        std::shared_ptr<Shader> newShader = Start<Shader>(name);
         shader = newShader;
         return newShader;
     }
@@ -39,7 +60,7 @@ std::shared_ptr<Texture> AquireTexture(const char* name, int rows, int cols)
     std::weak_ptr<Texture>& tex = map[std::string(name)];
     if (tex.expired())
     {
-        auto newTex = std::make_shared<Texture>(name, rows, cols);
+        auto newTex = Start<Texture>(name, rows, cols);
         tex = newTex;
         return newTex;
     }
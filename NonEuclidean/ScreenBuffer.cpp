@@ -22,7 +22,7 @@ void CheckError()
     }
 }
 
-ScreenBuffer::ScreenBuffer(int width, int height)
+ScreenBuffer::ScreenBuffer(int width, int height, bool stencil)
     : width(width)
     , height(height)
 {
@@ -45,11 +45,12 @@ ScreenBuffer::ScreenBuffer(int width, int height)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, texId[1], 0);
-    // depth attachment
+    // depth (and stencil) attachment
     glGenRenderbuffers(1, &renderBuf);
     glBindRenderbuffer(GL_RENDERBUFFER, renderBuf);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderBuf);
+    glRenderbufferStorage(GL_RENDERBUFFER, stencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, width, height);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderBuf);
 
     // Does the GPU support current FBO configuration?
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
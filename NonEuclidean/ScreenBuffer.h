@@ -7,7 +7,7 @@
 class ScreenBuffer
 {
 public:
-    ScreenBuffer(int width, int height);
+    ScreenBuffer(int width, int height, bool stencil = false);
     ~ScreenBuffer();
 
     void Bind();
@@ -4,15 +4,61 @@
 #include <iostream>
 #include <sstream>
 
+#ifndef GH_HEADLESS
+// Contents of a whole text file
+static std::string ReadSource(const std::string& fname)
+{
+    std::ifstream fin(fname);
+    std::stringstream buff;
+    buff << fin.rdbuf();
+    return buff.str();
+}
+#endif
+
 Shader::Shader(const char* name)
+{
+    Load(name);
+    Upload();
+}
+
+void Shader::Load(const char* name)
 {
     // Get the file paths
-    const std::string vert = "NonEuclidean/Shaders/" + std::string(name) + ".vert";
-    const std::string frag = "NonEuclidean/Shaders/" + std::string(name) + ".frag";
+    vertPath = "NonEuclidean/Shaders/" + std::string(name) + ".vert";
+    fragPath = "NonEuclidean/Shaders/" + std::string(name) + ".frag";
 
+#ifndef GH_HEADLESS
     // Load the shaders from disk
-    vertId = LoadShader(vert.c_str(), GL_VERTEX_SHADER);
-    fragId = LoadShader(frag.c_str(), GL_FRAGMENT_SHADER);
+    vertSource = ReadSource(vertPath);
+    fragSource = ReadSource(fragPath);
+
+    // Save variable bindings
+    const std::string& str = vertSource;
+    size_t ix = 0;
+    while (true)
+    {
+        ix = str.find("\nin ", ix);
+        if (ix == std::string::npos)
+        {
+            break;
+        }
+        ix = str.find(";", ix);
+        size_t start_ix = ix;
+        while (str[--start_ix] != ' ')
+            ;
+        attribs.push_back(str.substr(start_ix + 1, ix - start_ix - 1));
+    }
+#endif
+}
+
+void Shader::Upload()
+{
+    ready = true;
+#ifndef GH_HEADLESS
+    vertId = CompileShader(vertPath, vertSource, GL_VERTEX_SHADER);
+    fragId = CompileShader(fragPath, fragSource, GL_FRAGMENT_SHADER);
+    vertSource.clear();
+    fragSource.clear();
 
     // Create the program
     progId = glCreateProgram();
@@ -37,7 +83,7 @@ Shader::Shader(const char* name)
         log.resize(logLength);
         glGetProgramInfoLog(progId, logLength, &logLength, log.data());
 
-        std::ofstream fout(std::string(vert) + ".link.log");
+        std::ofstream fout(vertPath + ".link.log");
         fout.write(log.data(), logLength);
 
         progId = 0;
@@ -52,13 +98,17 @@ Shader::Shader(const char* name)
     mvId = glGetUniformLocation(progId, "mv");
     objIdId = glGetUniformLocation(progId, "objId");
     colorId = glGetUniformLocation(progId, "color");
+    uvTransformId = glGetUniformLocation(progId, "uvTransform");
+#endif
 }
 
 Shader::~Shader()
 {
+#ifndef GH_HEADLESS
     glDeleteProgram(progId);
     glDeleteShader(vertId);
     glDeleteShader(fragId);
+#endif
 }
 
 void Shader::Use()
@@ -66,13 +116,8 @@ void Shader::Use()
     glUseProgram(progId);
 }
 
-GLuint Shader::LoadShader(const char* fname, GLenum type)
+GLuint Shader::CompileShader(const std::string& fname, const std::string& str, GLenum type)
 {
-    // Read shader source from disk
-    std::ifstream fin(fname);
-    std::stringstream buff;
-    buff << fin.rdbuf();
-    const std::string str = buff.str();
     const char* source = str.c_str();
 
     // Create and compile shader
@@ -93,7 +138,7 @@ GLuint Shader::LoadShader(const char* fname, GLenum type)
         glGetShaderInfoLog(id, logLength, &logLength, log.data());
         std::string log_string = std::string(log.begin(), log.end());
 
-        std::ofstream fout(std::string(fname) + ".log");
+        std::ofstream fout(fname + ".log");
         fout.write(log.data(), logLength);
         fout.close();
 
@@ -102,25 +147,6 @@ GLuint Shader::LoadShader(const char* fname, GLenum type)
         return 0;
     }
 
-    // Save variable bindings
-    if (type == GL_VERTEX_SHADER)
-    {
-        size_t ix = 0;
-        while (true)
-        {
-            ix = str.find("\nin ", ix);
-            if (ix == std::string::npos)
-            {
-                break;
-            }
-            ix = str.find(";", ix);
-            size_t start_ix = ix;
-            while (str[--start_ix] != ' ')
-                ;
-            attribs.push_back(str.substr(start_ix + 1, ix - start_ix - 1));
-        }
-    }
-
     // Return the shader id
     return id;
 }
@@ -143,6 +169,11 @@ void Shader::SetColor(const Vector3& color)
     glUniform3f(colorId, color.x, color.y, color.z);
 }
 
+void Shader::SetUVTransform(float scaleX, float scaleY, float offsetX, float offsetY)
+{
+    glUniform4f(uvTransformId, scaleX, scaleY, offsetX, offsetY);
+}
+
 GLint Shader::GetUniformLocation(const char* name)
 {
     return glGetUniformLocation(progId, name);
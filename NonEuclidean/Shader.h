@@ -9,25 +9,39 @@
 class Shader
 {
 public:
+    // Shader that is filled in later by Load and Upload, see AquireShader
+    Shader() {}
     Shader(const char* name);
     ~Shader();
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // The two halves of loading from files: Load reads the sources on any thread, Upload compiles them
+    void Load(const char* name);
+    void Upload();
+    bool IsReady() const { return ready; }
 
     void Use();
     void SetMVP(const float* mvp, const float* mv);
     void SetObjId(int objId);
     void SetColor(const Vector3& color);
+    void SetUVTransform(float scaleX, float scaleY, float offsetX, float offsetY);
     GLuint GlId() const { return progId; }
     GLint GetUniformLocation(const char* name);
 
 private:
-    GLuint LoadShader(const char* fname, GLenum type);
+    GLuint CompileShader(const std::string& fname, const std::string& str, GLenum type);
 
     std::vector<std::string> attribs;
-    GLuint vertId;
-    GLuint fragId;
-    GLuint progId;
+    std::string vertPath, vertSource;
+    std::string fragPath, fragSource;
+    bool ready = false;
+    GLuint vertId = 0;
+    GLuint fragId = 0;
+    GLuint progId = 0;
     GLuint mvpId;
     GLuint mvId;
     GLuint objIdId;
     GLuint colorId;
+    GLuint uvTransformId;
 };
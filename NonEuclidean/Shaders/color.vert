@@ -1,17 +1,35 @@
 #version 450
 
-//Globals
-uniform mat4 mvp;
-uniform mat4 mv;
+//Per frame and per pass data, see RenderQueue
+struct ObjectData {
+	mat4 model;
+	mat4 normal;
+	vec4 color;
+};
+layout (std430, binding = 0) readonly buffer Objects {
+	ObjectData objects[];
+};
+layout (std140, binding = 0) uniform Camera {
+	mat4 viewProj;
+	int pickable;
+};
 
 //Inputs
 layout (location = 0) in vec3 in_pos;
 layout (location = 2) in vec3 in_normal;
 
+//Per instance inputs
+layout (location = 3) in int in_object;
+
 //Outputs
 out vec3 ex_normal;
+flat out vec3 ex_color;
+flat out int ex_objId;
 
 void main(void) {
-	gl_Position = mvp * vec4(in_pos, 1.0);
-	ex_normal = normalize((mv * vec4(in_normal, 0.0)).xyz);
+	ObjectData obj = objects[in_object];
+	gl_Position = viewProj * (obj.model * vec4(in_pos, 1.0));
+	ex_normal = normalize((obj.normal * vec4(in_normal, 0.0)).xyz);
+	ex_color = obj.color.rgb;
+	ex_objId = (pickable != 0 ? in_object : -1);
 }
@@ -3,6 +3,7 @@ precision highp float;
 
 //Inputs
 uniform sampler2D tex;
+uniform vec4 uvTransform;
 in vec4 ex_uv;
 
 //Outputs
@@ -10,6 +11,6 @@ out vec4 color;
 
 void main(void) {
 	vec2 uv = (ex_uv.xy / ex_uv.w);
-	uv = uv*0.5 + 0.5;
+	uv = uv*uvTransform.xy + uvTransform.zw;
 	color = vec4(texture2D(tex, uv).rgb, 1.0);
 }
@@ -5,10 +5,10 @@ precision highp float;
 
 //Inputs
 uniform sampler2D tex;
-uniform int objId;
 
 in vec2 ex_uv;
 in vec3 ex_normal;
+flat in int ex_objId;
 
 //Outputs
 layout (location = 0) out vec4 color;
@@ -17,5 +17,5 @@ layout (location = 1) out int objId_out;
 void main(void) {
 	float s = dot(ex_normal, LIGHT)*0.5 + 0.5;
 	color = vec4(texture(tex, ex_uv).rgb * s, 1.0);
-	objId_out = objId;
+	objId_out = ex_objId;
 }
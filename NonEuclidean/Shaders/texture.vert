@@ -1,20 +1,36 @@
 #version 450
 
-//Globals
-uniform mat4 mvp;
-uniform mat4 mv;
+//Per frame and per pass data, see RenderQueue
+struct ObjectData {
+	mat4 model;
+	mat4 normal;
+	vec4 color;
+};
+layout (std430, binding = 0) readonly buffer Objects {
+	ObjectData objects[];
+};
+layout (std140, binding = 0) uniform Camera {
+	mat4 viewProj;
+	int pickable;
+};
 
 //Inputs
 layout (location = 0) in vec3 in_pos;
 layout (location = 1) in vec2 in_uv;
 layout (location = 2) in vec3 in_normal;
 
+//Per instance inputs
+layout (location = 3) in int in_object;
+
 //Outputs
 out vec2 ex_uv;
 out vec3 ex_normal;
+flat out int ex_objId;
 
 void main(void) {
-	gl_Position = mvp * vec4(in_pos, 1.0);
+	ObjectData obj = objects[in_object];
+	gl_Position = viewProj * (obj.model * vec4(in_pos, 1.0));
 	ex_uv = in_uv;
-	ex_normal = normalize((mv * vec4(in_normal, 0.0)).xyz);
+	ex_normal = normalize((obj.normal * vec4(in_normal, 0.0)).xyz);
+	ex_objId = (pickable != 0 ? in_object : -1);
 }
@@ -0,0 +1,100 @@
+#include "StaticWorld.h"
+#include "AssetLoader.h"
+#include "GameHeader.h"
+#include "Mesh.h"
+
+#include <algorithm>
+
+void StaticWorld::Add(Object& obj)
+{
+    if (obj.mesh && !obj.mesh->IsReady() && GH_ASSETS)
+    {
+        // The colliders are only there once the mesh is loaded
+        GH_ASSETS->Finish();
+    }
+    if (!obj.mesh || obj.mesh->colliders.Empty() || Contains(obj))
+    {
+        return;
+    }
+
+    // Bring the colliders into world space
+    const Matrix4 localToWorld = obj.LocalToWorld();
+    const ColliderSoA& local = obj.mesh->colliders;
+    std::vector<Collider> baked;
+    baked.reserve(local.Size());
+    for (size_t i = 0; i < local.Size(); ++i)
+    {
+        const Collider collider = local.Get(i);
+        baked.push_back(Collider::FromAxes(
+            localToWorld.MulPoint(collider.Center()), localToWorld.MulDirection(collider.AxisX()),
+            localToWorld.MulDirection(collider.AxisY())));
+    }
+
+    Chunk chunk;
+    chunk.owner = &obj;
+    chunk.first = (uint32_t) colliders.Size();
+    chunk.count = (uint32_t) baked.size();
+    chunk.bvh.Build(baked);
+    for (size_t i = 0; i < baked.size(); ++i)
+    {
+        chunk.bounds.Extend(baked[i].Bounds());
+        colliders.Append(baked[i]);
+    }
+    grid.Insert((int) chunks.size(), chunk.bounds);
+    owners.insert(&obj);
+    chunks.push_back(std::move(chunk));
+}
+
+void StaticWorld::Remove(const Object& obj)
+{
+    if (owners.erase(&obj) == 0)
+    {
+        return;
+    }
+    auto chunk = std::find_if(chunks.begin(), chunks.end(), [&](const Chunk& c) { return c.owner == &obj; });
+    if (chunk == chunks.end())
+    {
+        return;
+    }
+
+    // Close the gap, the chunks after it move down
+    const uint32_t count = chunk->count;
+    colliders.Erase(chunk->first, count);
+    chunk = chunks.erase(chunk);
+    for (; chunk != chunks.end(); ++chunk) { chunk->first -= count; }
+
+    // The chunks after it changed their index too
+    grid.Clear();
+    for (size_t i = 0; i < chunks.size(); ++i) { grid.Insert((int) i, chunks[i].bounds); }
+}
+
+void StaticWorld::Clear()
+{
+    colliders.Clear();
+    chunks.clear();
+    grid.Clear();
+    owners.clear();
+}
+
+bool StaticWorld::Contains(const Object& obj) const
+{
+    return owners.count(&obj) != 0;
+}
+
+void StaticWorld::Query(
+    const AABB& bounds, std::vector<Range>& ranges, std::vector<int>& chunkScratch,
+    std::vector<ColliderBVH::Range>& rangeScratch) const
+{
+    ranges.clear();
+    // Sorted by index, which is the order the chunks were added in
+    grid.Query(bounds, chunkScratch);
+    for (int ix : chunkScratch)
+    {
+        const Chunk& chunk = chunks[ix];
+        chunk.bvh.Query(bounds, rangeScratch);
+        for (const ColliderBVH::Range& range : rangeScratch)
+        {
+            ranges.push_back({chunk.owner, chunk.first + range.first, range.count});
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "AABB.h"
+#include "BroadPhase.h"
+#include "ColliderBVH.h"
+#include "ColliderSoA.h"
+#include "Object.h"
+
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Colliders of objects that never move, baked into world space once when the
+ * object is placed. Every baked object owns a contiguous chunk of the buffer
+ * with its own hierarchy, so removing it again only touches that chunk. The
+ * chunk bounds are binned in a grid, so queries only visit nearby chunks.
+ */
+class StaticWorld
+{
+public:
+    // A run of colliders [first, first + count) belonging to one object
+    struct Range
+    {
+        Object* owner;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    void Add(Object& obj);
+    void Remove(const Object& obj);
+    void Clear();
+    bool Contains(const Object& obj) const;
+
+    /**
+     * Collects the runs of colliders whose bounds overlap the given world
+     * space bounds, in the order the objects were added. The scratch vectors
+     * are only used during the call, so concurrent queries can each pass
+     * their own.
+     */
+    void Query(
+        const AABB& bounds, std::vector<Range>& ranges, std::vector<int>& chunkScratch,
+        std::vector<ColliderBVH::Range>& rangeScratch) const;
+
+    const ColliderSoA& Colliders() const { return colliders; }
+
+private:
+    struct Chunk
+    {
+        Object* owner;
+        uint32_t first;
+        uint32_t count;
+        AABB bounds;
+        ColliderBVH bvh;
+    };
+
+    ColliderSoA colliders;
+    std::vector<Chunk> chunks;
+    // Chunk bounds by chunk index, and the objects that own a chunk
+    BroadPhase grid;
+    std::unordered_set<const Object*> owners;
+};
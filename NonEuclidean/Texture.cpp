@@ -6,16 +6,35 @@
 #include <fstream>
 
 Texture::Texture(const char* fname, int rows, int cols)
+{
+    Load(fname, rows, cols);
+    Upload();
+}
+
+Texture::~Texture()
+{
+    stbi_image_free(pixels);
+}
+
+void Texture::Load(const char* fname, int rows, int cols)
 {
     // Check if this is a 3D texture
     assert(rows >= 1 && cols >= 1);
     is3D = (rows > 1 || cols > 1);
+    this->rows = rows;
+    this->cols = cols;
 
     auto file = std::string("NonEuclidean/Textures/") + fname;
-    int width, height, channels;
-    auto data = stbi_load(file.c_str(), &width, &height, &channels, 0);
-    assert(data);
+#ifndef GH_HEADLESS
+    pixels = stbi_load(file.c_str(), &width, &height, &channels, 0);
+    assert(pixels);
+#endif
+}
 
+void Texture::Upload()
+{
+    ready = true;
+#ifndef GH_HEADLESS
     GLenum internalFormat;
     GLenum format;
     switch (channels)
@@ -54,7 +73,7 @@ Texture::Texture(const char* fname, int rows, int cols)
         glGenerateMipmap(GL_TEXTURE_2D);
         glTexImage3D(
             GL_TEXTURE_2D_ARRAY, 0, internalFormat, width / rows, height / cols, rows * cols, 0, format,
-            GL_UNSIGNED_BYTE, data);
+            GL_UNSIGNED_BYTE, pixels);
     }
     else
     {
@@ -63,11 +82,13 @@ Texture::Texture(const char* fname, int rows, int cols)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
     }
 
     // Clenup
-    stbi_image_free(data);
+    stbi_image_free(pixels);
+    pixels = nullptr;
+#endif
 }
 
 void Texture::Use()
@@ -5,11 +5,30 @@
 class Texture
 {
 public:
+    // Texture that is filled in later by Load and Upload, see AquireTexture
+    Texture() {}
     Texture(const char* fname, int rows, int cols);
+    ~Texture();
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // The two halves of loading from a file: Load decodes it on any thread, Upload copies it to video memory
+    void Load(const char* fname, int rows, int cols);
+    void Upload();
+    bool IsReady() const { return ready; }
 
     void Use();
 
 private:
-    GLuint texId;
-    bool   is3D;
+    GLuint texId = 0;
+    bool   is3D = false;
+    bool   ready = false;
+
+    // Decoded image waiting for its upload
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int rows = 1;
+    int cols = 1;
 };
@@ -0,0 +1,82 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numThreads)
+    : task(nullptr)
+    , taskCount(0)
+    , nextIndex(0)
+    , busyWorkers(0)
+    , generation(0)
+    , quit(false)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = (int) std::thread::hardware_concurrency();
+    }
+    for (int i = 1; i < numThreads; ++i) { workers.emplace_back(&ThreadPool::WorkerMain, this, i); }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) { worker.join(); }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, int)>& fn)
+{
+    if (workers.empty() || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i) { fn(i, 0); }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        taskCount = count;
+        nextIndex.store(0);
+        busyWorkers = (int) workers.size();
+        generation += 1;
+    }
+    wake.notify_all();
+    RunTasks(0);
+
+    // Every worker checks in once per loop, so the next loop can not start early
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busyWorkers == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::WorkerMain(int thread)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit)
+            {
+                return;
+            }
+            seen = generation;
+        }
+
+        RunTasks(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        busyWorkers -= 1;
+        if (busyWorkers == 0)
+        {
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunTasks(int thread)
+{
+    for (size_t i = nextIndex.fetch_add(1); i < taskCount; i = nextIndex.fetch_add(1)) { (*task)(i, thread); }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads for data parallel loops. The calling thread
+ * takes part in every loop, so a pool of one thread runs everything inline.
+ */
+class ThreadPool
+{
+public:
+    // Zero picks one thread per hardware thread
+    explicit ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+
+    int NumThreads() const { return (int) workers.size() + 1; }
+
+    /**
+     * Calls fn(index, thread) for every index in [0, count) and returns once
+     * all calls are done. Indices are handed out in order, but may run
+     * concurrently on any thread, so fn must only touch state owned by its
+     * index or by the thread.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t, int)>& fn);
+
+private:
+    void WorkerMain(int thread);
+    void RunTasks(int thread);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t, int)>* task;
+    size_t taskCount;
+    std::atomic<size_t> nextIndex;
+    int busyWorkers;
+    uint64_t generation;
+    bool quit;
+};
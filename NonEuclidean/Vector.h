@@ -211,6 +211,8 @@ public:
     inline Vector3 XYZNormalized() const { return Vector3(x, y, z).Normalized(); }
     inline Vector3 Homogenized() const { return Vector3(x / w, y / w, z / w); }
 
+    inline Vector4 operator+(const Vector4& b) const { return Vector4(x + b.x, y + b.y, z + b.z, w + b.w); }
+    inline Vector4 operator-(const Vector4& b) const { return Vector4(x - b.x, y - b.y, z - b.z, w - b.w); }
     inline Vector4 operator*(float b) const { return Vector4(x * b, y * b, z * b, w * b); }
     inline Vector4 operator/(float b) const { return Vector4(x / b, y / b, z / b, w / b); }
     inline void operator*=(float b)
@@ -0,0 +1,152 @@
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Size of one value of the given type
+static GLuint TypeSize(GLenum type)
+{
+    return (type == GL_FLOAT) ? sizeof(float) : sizeof(uint16_t);
+}
+
+// Rounds up to the 4 byte alignment of vertex attributes
+static GLuint Align(GLuint offset)
+{
+    return (offset + 3) & ~3u;
+}
+
+// True if every value survives the round trip through a half float
+static bool ExactInHalf(const std::vector<float>& values)
+{
+    for (float v : values)
+    {
+        if (VertexFormat::HalfToFloat(VertexFormat::FloatToHalf(v)) != v)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+VertexFormat VertexFormat::Choose(const std::vector<float>& verts, const std::vector<float>& uvs, int uvSize)
+{
+    GLenum uvType = GL_FLOAT;
+    if (ExactInHalf(uvs))
+    {
+        uvType = GL_HALF_FLOAT;
+    }
+    else if (std::all_of(uvs.begin(), uvs.end(), [](float v) { return v >= 0.0f && v <= 1.0f; }))
+    {
+        uvType = GL_UNSIGNED_SHORT;
+    }
+    VertexFormat format;
+    FromTypes(ExactInHalf(verts) ? GL_HALF_FLOAT : GL_FLOAT, uvType, uvSize, format);
+    return format;
+}
+
+bool VertexFormat::FromTypes(GLenum posType, GLenum uvType, int uvSize, VertexFormat& format)
+{
+    if ((posType != GL_FLOAT && posType != GL_HALF_FLOAT)
+        || (uvType != GL_FLOAT && uvType != GL_HALF_FLOAT && uvType != GL_UNSIGNED_SHORT)
+        || (uvSize != 2 && uvSize != 3))
+    {
+        return false;
+    }
+    format.posType = posType;
+    format.uvType = uvType;
+    format.uvSize = uvSize;
+    format.uvOffset = Align(3 * TypeSize(posType));
+    format.normalOffset = Align(format.uvOffset + uvSize * TypeSize(uvType));
+    format.stride = (GLsizei) (format.normalOffset + sizeof(uint32_t));
+    return true;
+}
+
+void VertexFormat::Pack(
+    const std::vector<float>& verts,
+    const std::vector<float>& uvs,
+    const std::vector<float>& normals,
+    std::vector<uint8_t>& data) const
+{
+    const size_t count = verts.size() / 3;
+    data.assign(count * stride, 0);
+    auto put = [](uint8_t* dst, GLenum type, const float* src, int n) {
+        for (int i = 0; i < n; ++i)
+        {
+            if (type == GL_FLOAT)
+            {
+                memcpy(dst + i * sizeof(float), &src[i], sizeof(float));
+                continue;
+            }
+            const uint16_t v = (type == GL_HALF_FLOAT) ? FloatToHalf(src[i])
+                                                       : (uint16_t) std::lround(src[i] * 65535.0f);
+            memcpy(dst + i * sizeof(uint16_t), &v, sizeof(uint16_t));
+        }
+    };
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t* vertex = &data[i * stride];
+        put(vertex, posType, &verts[i * 3], 3);
+        put(vertex + uvOffset, uvType, &uvs[i * uvSize], uvSize);
+
+        // Three signed 10 bit components, the 2 bit w is unused
+        uint32_t normal = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const float n = std::min(std::max(normals[i * 3 + k], -1.0f), 1.0f);
+            normal |= ((uint32_t) std::lround(n * 511.0f) & 0x3FF) << (10 * k);
+        }
+        memcpy(vertex + normalOffset, &normal, sizeof(normal));
+    }
+}
+
+uint16_t VertexFormat::FloatToHalf(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = (uint16_t) ((x >> 16) & 0x8000);
+    const int exp = (int) ((x >> 23) & 0xFF) - 127 + 15;
+    uint32_t mant = x & 0x7FFFFF;
+    if (exp >= 31)
+    {
+        // Too large, or infinity and NaN
+        return sign | (uint16_t) (0x7C00 | (((x & 0x7FFFFFFF) > 0x7F800000) ? 0x200 : 0));
+    }
+    if (exp <= 0)
+    {
+        // Subnormal, the implicit leading one becomes part of the mantissa
+        if (exp < -10)
+        {
+            return sign;
+        }
+        mant |= 0x800000;
+        const int shift = 14 - exp;
+        uint32_t half = mant >> shift;
+        const uint32_t rest = mant & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        half += (rest > halfway || (rest == halfway && (half & 1))) ? 1 : 0;
+        return sign | (uint16_t) half;
+    }
+
+    // Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = ((uint32_t) exp << 10) | (mant >> 13);
+    const uint32_t rest = mant & 0x1FFF;
+    half += (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ? 1 : 0;
+    return sign | (uint16_t) half;
+}
+
+float VertexFormat::HalfToFloat(uint16_t h)
+{
+    const uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1F;
+    const uint32_t mant = h & 0x3FF;
+    if (exp == 0)
+    {
+        const float v = std::ldexp((float) mant, -24);
+        return sign ? -v : v;
+    }
+    const uint32_t x = sign | ((exp == 31) ? (0xFF << 23) : ((exp - 15 + 127) << 23)) | (mant << 13);
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
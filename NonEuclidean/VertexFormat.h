@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Layout of the interleaved vertex buffer of a mesh: position, UV and
+ * normal, each packed as small as it can be without visible loss.
+ */
+struct VertexFormat
+{
+    GLenum posType = GL_FLOAT; // GL_FLOAT or GL_HALF_FLOAT
+    GLenum uvType = GL_FLOAT;  // GL_FLOAT, GL_HALF_FLOAT or normalized GL_UNSIGNED_SHORT
+    GLint uvSize = 2;
+    GLuint uvOffset = 0;
+    GLuint normalOffset = 0;
+    GLsizei stride = 0;
+
+    /**
+     * Positions use half floats only if every coordinate is exact in them.
+     * UVs use half floats under the same rule, normalized 16 bit if they all
+     * lie in [0, 1] and floats otherwise. Normals are always 10 bit signed
+     * normalized, GL_INT_2_10_10_10_REV.
+     */
+    static VertexFormat Choose(const std::vector<float>& verts, const std::vector<float>& uvs, int uvSize);
+
+    // Lays out the attributes for the given types, false if they are none Choose picks
+    static bool FromTypes(GLenum posType, GLenum uvType, int uvSize, VertexFormat& format);
+
+    // Interleaves the attributes into data, stride bytes per vertex
+    void Pack(
+        const std::vector<float>& verts,
+        const std::vector<float>& uvs,
+        const std::vector<float>& normals,
+        std::vector<uint8_t>& data) const;
+
+    static uint16_t FloatToHalf(float f);
+    static float HalfToFloat(uint16_t h);
+};